@@ -0,0 +1,176 @@
+import numpy as np
+import os
+import glob
+import argparse
+import onnxruntime as ort
+from google.protobuf.message import DecodeError
+from onnxruntime.quantization import (
+    CalibrationDataReader,
+    CalibrationMethod,
+    QuantFormat,
+    QuantType,
+    quantize_static,
+)
+import test_pb2 as pb
+
+# --- Model Inputs ---
+# Feature sizes must match the C++ FeatureEncoder (src/include/FeatureEncoder.hpp).
+NN1_INPUT_SIZE = 8    # scores, bags, 4 bids
+NN2_INPUT_SIZE = 118  # scores, bags, bids, hand, trick, tricks won, spades broken, player
+NN3_INPUT_SIZE = 4    # total points, point diff, own bags, other bags
+
+QUANTIZED_SUFFIX = ".int8.onnx"
+
+# --- Data Loading ---
+
+def read_samples(filepaths):
+    """Reads every TrainingSample from one or more size-delimited Protobuf files."""
+    samples = []
+    for filepath in filepaths:
+        with open(filepath, 'rb') as f:
+            while True:
+                size_bytes = f.read(4)
+                if len(size_bytes) < 4:
+                    break
+                size = np.frombuffer(size_bytes, dtype=np.int32)[0]
+                msg_bytes = f.read(size)
+                if len(msg_bytes) != size:
+                    print(f"Warning: Truncated message at end of {filepath}.")
+                    break
+                sample = pb.TrainingSample()
+                try:
+                    sample.ParseFromString(msg_bytes)
+                except DecodeError:
+                    # Older iterations used a raw float layout; those files cannot be read here.
+                    print(f"Warning: {filepath} is not a size-delimited Protobuf file, skipping the rest of it.")
+                    break
+                samples.append(sample)
+    return samples
+
+def nn3_features(sample):
+    """Mirrors stateToNN3Features: the value net sees scores from the deciding team's perspective."""
+    t1_score, t2_score, t1_bags, t2_bags = sample.state_features[:4]
+    if sample.player_idx % 2 == 0:
+        team_score, other_score, team_bags, other_bags = t1_score, t2_score, t1_bags, t2_bags
+    else:
+        team_score, other_score, team_bags, other_bags = t2_score, t1_score, t2_bags, t1_bags
+    return [team_score + other_score, team_score - other_score, team_bags, other_bags]
+
+def build_feature_sets(samples):
+    """Splits samples into per-network input matrices (plus NN3 outcome labels)."""
+    nn1, nn2, nn3, nn3_labels = [], [], [], []
+    for sample in samples:
+        features = list(sample.state_features)
+        if sample.is_bidding and len(features) == NN1_INPUT_SIZE:
+            nn1.append(features)
+        elif not sample.is_bidding and len(features) == NN2_INPUT_SIZE:
+            nn2.append(features)
+        if len(features) >= 4:
+            nn3.append(nn3_features(sample))
+            nn3_labels.append(sample.actual_game_win_value)
+    as_matrix = lambda rows, width: np.array(rows, dtype=np.float32).reshape(-1, width)
+    return {
+        'nn1': as_matrix(nn1, NN1_INPUT_SIZE),
+        'nn2': as_matrix(nn2, NN2_INPUT_SIZE),
+        'nn3': as_matrix(nn3, NN3_INPUT_SIZE),
+        'nn3_labels': np.array(nn3_labels, dtype=np.float32),
+    }
+
+def split_holdout(matrix, holdout_fraction):
+    """Keeps the tail of the file order as the held-out set so calibration never sees it."""
+    n_holdout = int(len(matrix) * holdout_fraction)
+    split = len(matrix) - n_holdout
+    return matrix[:split], matrix[split:]
+
+# --- Calibration ---
+
+class FeatureCalibrationReader(CalibrationDataReader):
+    """Feeds calibration batches of real self-play inputs to the ORT static quantizer."""
+    def __init__(self, input_name, matrix, max_samples, batch_size=64):
+        if len(matrix) > max_samples:
+            rng = np.random.default_rng(0)
+            matrix = matrix[rng.choice(len(matrix), max_samples, replace=False)]
+        self.batches = iter([{input_name: matrix[i:i + batch_size]} for i in range(0, len(matrix), batch_size)])
+
+    def get_next(self):
+        return next(self.batches, None)
+
+def quantize_model(fp32_path, int8_path, calibration_matrix, max_calibration_samples):
+    """Per-channel int8 weights, uint8 activations (the U8S8 path ORT maps onto VNNI kernels)."""
+    input_name = ort.InferenceSession(fp32_path, providers=['CPUExecutionProvider']).get_inputs()[0].name
+    reader = FeatureCalibrationReader(input_name, calibration_matrix, max_calibration_samples)
+    quantize_static(
+        fp32_path,
+        int8_path,
+        reader,
+        quant_format=QuantFormat.QDQ,
+        per_channel=True,
+        activation_type=QuantType.QUInt8,
+        weight_type=QuantType.QInt8,
+        calibrate_method=CalibrationMethod.MinMax,
+    )
+
+# --- Accuracy Report ---
+
+def run_model(path, matrix):
+    session = ort.InferenceSession(path, providers=['CPUExecutionProvider'])
+    input_name = session.get_inputs()[0].name
+    return session.run(None, {input_name: matrix})[0]
+
+def report_policy_delta(name, fp32_out, int8_out):
+    eps = 1e-8
+    kl = np.sum(fp32_out * (np.log(fp32_out + eps) - np.log(int8_out + eps)), axis=1)
+    top1 = np.mean(np.argmax(fp32_out, axis=1) == np.argmax(int8_out, axis=1))
+    print(f"  {name}: mean |dp| = {np.mean(np.abs(fp32_out - int8_out)):.5f}, "
+          f"mean KL(fp32||int8) = {np.mean(kl):.5f}, top-1 agreement = {top1 * 100:.2f}%")
+
+def report_value_delta(name, fp32_out, int8_out, labels):
+    fp32_out, int8_out = fp32_out.reshape(-1), int8_out.reshape(-1)
+    fp32_acc = np.mean((fp32_out > 0.5) == (labels > 0.5))
+    int8_acc = np.mean((int8_out > 0.5) == (labels > 0.5))
+    print(f"  {name}: mean |dv| = {np.mean(np.abs(fp32_out - int8_out)):.5f}, "
+          f"outcome accuracy fp32 = {fp32_acc * 100:.2f}%, int8 = {int8_acc * 100:.2f}% "
+          f"(delta {(int8_acc - fp32_acc) * 100:+.2f}%)")
+
+# --- Main ---
+
+def main(args):
+    data_files = sorted(glob.glob(args.input_data_glob))
+    if not data_files:
+        raise SystemExit(f"No data files match {args.input_data_glob}")
+    print(f"Reading calibration data from {len(data_files)} file(s)...")
+    feature_sets = build_feature_sets(read_samples(data_files))
+
+    print("\n--- Quantization Report (held-out set) ---")
+    for name in ('nn1', 'nn2', 'nn3', 'pv'):
+        fp32_path = os.path.join(args.model_path, f"{name}_model.onnx")
+        int8_path = os.path.join(args.model_path, f"{name}_model{QUANTIZED_SUFFIX}")
+        if not os.path.exists(fp32_path):
+            print(f"  {name}: no model at {fp32_path}, skipping.")
+            continue
+        # The fused policy+value model reads the same features as NN2.
+        features = feature_sets['nn2' if name == 'pv' else name]
+        calibration, holdout = split_holdout(features, args.holdout_fraction)
+        if len(calibration) == 0 or len(holdout) == 0:
+            print(f"  {name}: not enough samples to calibrate and evaluate, skipping.")
+            continue
+
+        quantize_model(fp32_path, int8_path, calibration, args.calibration_samples)
+        fp32_out = run_model(fp32_path, holdout)
+        int8_out = run_model(int8_path, holdout)
+        if name == 'nn3':
+            _, labels = split_holdout(feature_sets['nn3_labels'], args.holdout_fraction)
+            report_value_delta(name, fp32_out, int8_out, labels)
+        else:
+            report_policy_delta(name, fp32_out, int8_out)
+        fp32_size, int8_size = os.path.getsize(fp32_path), os.path.getsize(int8_path)
+        print(f"  {name}: {fp32_size} -> {int8_size} bytes, saved to {int8_path}")
+    print("------------------------------------------")
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Quantize the Spades ONNX models to int8 using self-play data for calibration.")
+    parser.add_argument("--model-path", type=str, required=True, help="Directory containing nnX_model.onnx files.")
+    parser.add_argument("--input-data-glob", type=str, default="data/*.bin", help="Glob of size-delimited Protobuf data files.")
+    parser.add_argument("--holdout-fraction", type=float, default=0.1, help="Fraction of samples held out for the accuracy report.")
+    parser.add_argument("--calibration-samples", type=int, default=4096, help="Maximum number of samples used for calibration per model.")
+    main(parser.parse_args())
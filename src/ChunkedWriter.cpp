@@ -0,0 +1,262 @@
+#include "include/ChunkedWriter.hpp"
+#include "include/Crc32c.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static constexpr char kChunkMagic[8] = { 'S', 'P', 'D', 'C', 'H', 'N', 'K', '1' };
+static constexpr uint32_t kMaxChunkBytes = 64 * 1024 * 1024;
+static constexpr size_t kScanWindow = 64 * 1024;
+
+static uint32_t headerCrc(const ChunkHeader& header) {
+    return crc32c(&header, offsetof(ChunkHeader, header_crc));
+}
+
+static bool isValidHeader(const ChunkHeader& header) {
+    return std::memcmp(header.magic, kChunkMagic, sizeof(kChunkMagic)) == 0 &&
+        header.header_crc == headerCrc(header) &&
+        header.chunk_bytes > sizeof(ChunkHeader) && header.chunk_bytes <= kMaxChunkBytes &&
+        header.payload_bytes <= header.chunk_bytes - sizeof(ChunkHeader);
+}
+
+// --- ChunkedWriter ---
+
+ChunkedWriter::ChunkedWriter(const std::string& path, uint32_t chunk_bytes) : path(path), chunk_bytes(chunk_bytes) {
+    std::error_code ec;
+    if (std::filesystem::exists(path, ec) && std::filesystem::file_size(path, ec) > 0) {
+        std::ifstream existing(path, std::ios::binary);
+        ChunkHeader header;
+        if (!existing.read(reinterpret_cast<char*>(&header), sizeof(header)) || !isValidHeader(header)) {
+            throw std::runtime_error("Not a chunked data file written by this tool: " + path);
+        }
+        this->chunk_bytes = header.chunk_bytes;
+    }
+    if (this->chunk_bytes <= sizeof(ChunkHeader) || this->chunk_bytes > kMaxChunkBytes) {
+        throw std::runtime_error("Invalid chunk size for " + path);
+    }
+
+    // Every chunk goes out as one write on an append-mode descriptor. On POSIX that
+    // makes concurrent appends from several processes land whole; the Windows CRT
+    // seeks to the end before each write, which is only safe for a single process.
+#ifdef _WIN32
+    fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+    if (fd < 0) {
+        throw std::runtime_error("Could not open data file for writing: " + path);
+    }
+    current.assign(this->chunk_bytes, 0);
+}
+
+ChunkedWriter::~ChunkedWriter() {
+    try {
+        close();
+    }
+    catch (const std::exception&) {
+        // Nothing sensible to do from a destructor; close() reports errors to explicit callers.
+    }
+}
+
+void ChunkedWriter::writeGame(const std::vector<TrainingSample>& samples) {
+    const size_t capacity = chunk_bytes - sizeof(ChunkHeader);
+    std::vector<std::vector<char>> sealed;
+    std::string serialized_data;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closed) {
+            throw std::runtime_error("ChunkedWriter used after close: " + path);
+        }
+        for (const auto& sample : samples) {
+            if (!sample.SerializeToString(&serialized_data)) {
+                throw std::runtime_error("Failed to serialize training sample.");
+            }
+            int32_t size = static_cast<int32_t>(serialized_data.size());
+            size_t needed = sizeof(size) + serialized_data.size();
+            if (needed > capacity) {
+                throw std::runtime_error("Training sample larger than a chunk of " + path);
+            }
+            if (current_used + needed > capacity) {
+                sealChunk(current, current_used, current_records);
+                sealed.push_back(std::move(current));
+                current.assign(chunk_bytes, 0);
+                current_used = 0;
+                current_records = 0;
+            }
+            char* out = current.data() + sizeof(ChunkHeader) + current_used;
+            std::memcpy(out, &size, sizeof(size));
+            std::memcpy(out + sizeof(size), serialized_data.data(), serialized_data.size());
+            current_used += static_cast<uint32_t>(needed);
+            current_records++;
+            record_count++;
+        }
+        chunk_count += sealed.size();
+    }
+    // Full chunks are appended outside the lock; the order between threads does not matter.
+    for (const auto& chunk : sealed) {
+        appendChunk(chunk);
+    }
+}
+
+void ChunkedWriter::sealChunk(std::vector<char>& chunk, uint32_t payload_bytes, uint32_t records) {
+    ChunkHeader header{};
+    std::memcpy(header.magic, kChunkMagic, sizeof(kChunkMagic));
+    header.chunk_bytes = chunk_bytes;
+    header.payload_bytes = payload_bytes;
+    header.record_count = records;
+    header.payload_crc = crc32c(chunk.data() + sizeof(ChunkHeader), payload_bytes);
+    header.header_crc = headerCrc(header);
+    std::memcpy(chunk.data(), &header, sizeof(header));
+}
+
+void ChunkedWriter::appendChunk(const std::vector<char>& chunk) {
+    const char* data = chunk.data();
+    size_t remaining = chunk.size();
+    while (remaining > 0) {
+#ifdef _WIN32
+        int written = _write(fd, data, static_cast<unsigned int>(remaining));
+#else
+        ssize_t written = ::write(fd, data, remaining);
+#endif
+        if (written <= 0) {
+            throw std::runtime_error("Failed to write training data to " + path + ".");
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+}
+
+void ChunkedWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed) return;
+    closed = true;
+    if (current_records > 0) {
+        sealChunk(current, current_used, current_records);
+        chunk_count++;
+        appendChunk(current);
+    }
+#ifdef _WIN32
+    int result = _close(fd);
+#else
+    int result = ::close(fd);
+#endif
+    fd = -1;
+    if (result != 0) {
+        throw std::runtime_error("Failed to close " + path + ".");
+    }
+}
+
+// --- ChunkedReader ---
+
+ChunkedReader::ChunkedReader(const std::string& path, uint64_t begin, uint64_t end) : path(path), in(path, std::ios::binary) {
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open " + path);
+    }
+    std::error_code ec;
+    file_size = std::filesystem::file_size(path, ec);
+    this->end = std::min<uint64_t>(end, file_size);
+    position = findHeader(begin);
+    if (begin == 0) {
+        read_stats.skipped_bytes = position; // Garbage before the first chunk
+    }
+}
+
+bool ChunkedReader::isChunkedFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    ChunkHeader header;
+    return in.read(reinterpret_cast<char*>(&header), sizeof(header)) && isValidHeader(header);
+}
+
+bool ChunkedReader::readHeaderAt(uint64_t offset, ChunkHeader& header) {
+    in.clear();
+    in.seekg(static_cast<std::streamoff>(offset));
+    return in.read(reinterpret_cast<char*>(&header), sizeof(header)) && isValidHeader(header);
+}
+
+// First offset >= from with a valid chunk header, or the end of the range if there is none.
+uint64_t ChunkedReader::findHeader(uint64_t from) {
+    std::vector<char> window(kScanWindow + sizeof(kChunkMagic));
+    for (uint64_t base = from; base < end; base += kScanWindow) {
+        size_t wanted = static_cast<size_t>(std::min<uint64_t>(window.size(), file_size - base));
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(base));
+        if (!in.read(window.data(), static_cast<std::streamsize>(wanted))) {
+            break;
+        }
+        size_t limit = static_cast<size_t>(std::min<uint64_t>(kScanWindow, end - base));
+        for (size_t i = 0; i < limit && i + sizeof(kChunkMagic) <= wanted; ++i) {
+            const char* hit = static_cast<const char*>(std::memchr(window.data() + i, kChunkMagic[0], limit - i));
+            if (!hit) break;
+            i = static_cast<size_t>(hit - window.data());
+            ChunkHeader header;
+            if (i + sizeof(kChunkMagic) <= wanted && std::memcmp(hit, kChunkMagic, sizeof(kChunkMagic)) == 0 &&
+                readHeaderAt(base + i, header)) {
+                return base + i;
+            }
+        }
+    }
+    return end;
+}
+
+bool ChunkedReader::loadChunk() {
+    while (position < end) {
+        ChunkHeader header;
+        bool intact = false;
+        if (readHeaderAt(position, header)) {
+            // A chunk running past the end of the file is a torn final write
+            chunk.resize(header.chunk_bytes);
+            in.clear();
+            in.seekg(static_cast<std::streamoff>(position));
+            intact = position + header.chunk_bytes <= file_size && in.read(chunk.data(), header.chunk_bytes) &&
+                crc32c(chunk.data() + sizeof(ChunkHeader), header.payload_bytes) == header.payload_crc;
+
+            // The framing of the records must account for exactly the payload
+            size_t offset = sizeof(ChunkHeader);
+            size_t limit = sizeof(ChunkHeader) + header.payload_bytes;
+            uint32_t records = 0;
+            while (intact && offset < limit) {
+                int32_t size = 0;
+                std::memcpy(&size, chunk.data() + offset, sizeof(size));
+                offset += sizeof(size) + static_cast<size_t>(size);
+                intact = size >= 0 && offset <= limit;
+                records++;
+            }
+            intact = intact && records == header.record_count;
+            if (intact) {
+                read_stats.chunks++;
+                cursor = sizeof(ChunkHeader);
+                payload_end = limit;
+                position += header.chunk_bytes;
+                return true;
+            }
+            read_stats.damaged_chunks++;
+        }
+        uint64_t next = findHeader(position + 1);
+        read_stats.skipped_bytes += next - position;
+        position = next;
+    }
+    return false;
+}
+
+bool ChunkedReader::next(std::string& record) {
+    while (cursor >= payload_end) {
+        if (!loadChunk()) return false;
+    }
+    int32_t size = 0;
+    std::memcpy(&size, chunk.data() + cursor, sizeof(size));
+    record.assign(chunk.data() + cursor + sizeof(size), static_cast<size_t>(size));
+    cursor += sizeof(size) + static_cast<size_t>(size);
+    read_stats.records++;
+    return true;
+}
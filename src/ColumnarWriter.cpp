@@ -0,0 +1,232 @@
+#include "include/ColumnarWriter.hpp"
+#include "include/FeatureEncoder.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+// --- NpyColumn ---
+
+static constexpr size_t kNpyHeaderBytes = 128; // Magic + version + length + padded dict; 64-byte aligned
+static constexpr char kNpyMagic[] = "\x93NUMPY";
+
+NpyColumn::NpyColumn(const std::string& path, const std::string& descr, size_t element_size, size_t row_width)
+    : path(path), descr(descr), row_width(row_width), row_bytes(element_size * std::max<size_t>(row_width, 1)) {
+    file = std::fopen(path.c_str(), "r+b");
+    if (file) {
+        // Existing column: the header's row count is only published on close, so after a
+        // crash it is stale. Count the whole rows on disk instead; the caller lines the
+        // columns up (see resize).
+        char header[kNpyHeaderBytes];
+        if (std::fread(header, 1, kNpyHeaderBytes, file) != kNpyHeaderBytes || std::string(header, 6) != std::string(kNpyMagic, 6)) {
+            std::fclose(file);
+            throw std::runtime_error("Not a columnar data file written by this tool: " + path);
+        }
+        std::fclose(file);
+        row_count = (std::filesystem::file_size(path) - kNpyHeaderBytes) / row_bytes;
+        file = std::fopen(path.c_str(), "r+b");
+        if (!file) {
+            throw std::runtime_error("Could not open data file for writing: " + path);
+        }
+    }
+    else {
+        created = true;
+        file = std::fopen(path.c_str(), "w+b");
+        if (!file) {
+            throw std::runtime_error("Could not open data file for writing: " + path);
+        }
+        writeHeader();
+    }
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+    seekToEnd();
+}
+
+void NpyColumn::seekToEnd() {
+    // 64-bit offsets for multi-GB columns
+#ifdef _WIN32
+    _fseeki64(file, static_cast<long long>(kNpyHeaderBytes + row_count * row_bytes), SEEK_SET);
+#else
+    fseeko(file, static_cast<off_t>(kNpyHeaderBytes + row_count * row_bytes), SEEK_SET);
+#endif
+}
+
+NpyColumn::~NpyColumn() {
+    close();
+}
+
+void NpyColumn::writeHeader() {
+    std::string shape = row_width == 0
+        ? "(" + std::to_string(row_count) + ",)"
+        : "(" + std::to_string(row_count) + ", " + std::to_string(row_width) + ")";
+    std::string dict = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': " + shape + ", }";
+    dict.resize(kNpyHeaderBytes - 10 - 1, ' ');
+    dict += '\n';
+
+    uint16_t dict_len = static_cast<uint16_t>(dict.size());
+    char header[kNpyHeaderBytes];
+    std::copy(kNpyMagic, kNpyMagic + 6, header);
+    header[6] = 1; // Format version 1.0
+    header[7] = 0;
+    header[8] = static_cast<char>(dict_len & 0xFF);
+    header[9] = static_cast<char>(dict_len >> 8);
+    std::copy(dict.begin(), dict.end(), header + 10);
+
+    std::fseek(file, 0, SEEK_SET);
+    if (std::fwrite(header, 1, kNpyHeaderBytes, file) != kNpyHeaderBytes) {
+        throw std::runtime_error("Failed to write header of " + path);
+    }
+}
+
+void NpyColumn::appendRows(const void* data, size_t rows) {
+    if (std::fwrite(data, row_bytes, rows, file) != rows) {
+        throw std::runtime_error("Failed to write training data to " + path);
+    }
+    row_count += rows;
+}
+
+void NpyColumn::resize(uint64_t rows) {
+    if (rows > row_count) {
+        std::vector<char> zeros(static_cast<size_t>(rows - row_count) * row_bytes, 0);
+        appendRows(zeros.data(), static_cast<size_t>(rows - row_count));
+    }
+    else if (rows < row_count) {
+        // Closed around the resize: Windows refuses to shrink a file that is open
+        std::fclose(file);
+        file = nullptr;
+        row_count = rows;
+        std::filesystem::resize_file(path, kNpyHeaderBytes + row_count * row_bytes);
+        file = std::fopen(path.c_str(), "r+b");
+        if (!file) {
+            throw std::runtime_error("Could not open data file for writing: " + path);
+        }
+        std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+        seekToEnd();
+    }
+}
+
+void NpyColumn::close() {
+    if (!file) return;
+    std::fflush(file);
+    writeHeader(); // Publish the final row count
+    std::fclose(file);
+    file = nullptr;
+}
+
+// --- ColumnarWriter ---
+
+static void writeManifest(const std::string& directory) {
+    std::ofstream manifest(directory + "/manifest.json", std::ios::trunc);
+    manifest << "{\"format\": \"spades-columnar\", \"format_version\": 1, \"feature_version\": "
+             << FeatureEncoder::kFeatureVersion << "}\n";
+}
+
+// Creates the dataset directory, or checks that an existing one holds features in the
+// current FeatureEncoder layout: appending rows of another layout would mix the two.
+static std::string prepareDirectory(const std::string& directory) {
+    std::ifstream existing(directory + "/manifest.json");
+    if (existing) {
+        std::string manifest((std::istreambuf_iterator<char>(existing)), std::istreambuf_iterator<char>());
+        size_t pos = manifest.find("\"feature_version\":");
+        int version = pos == std::string::npos ? -1 : std::atoi(manifest.c_str() + pos + 18);
+        if (version != FeatureEncoder::kFeatureVersion) {
+            throw std::runtime_error("Columnar dataset " + directory + " holds feature version " + std::to_string(version) +
+                                     ", not " + std::to_string(FeatureEncoder::kFeatureVersion) + "; write to a new directory.");
+        }
+    }
+    std::filesystem::create_directories(std::filesystem::path(directory) / "bidding");
+    std::filesystem::create_directories(std::filesystem::path(directory) / "playing");
+    writeManifest(directory); // Up front, so a session that crashes still leaves one
+    return directory;
+}
+
+ColumnarWriter::PhaseColumns::PhaseColumns(const std::string& directory, size_t feature_width, size_t policy_width)
+    : features(directory + "/features.npy", "<f4", sizeof(float), feature_width),
+      policy(directory + "/policy.npy", "<f4", sizeof(float), policy_width),
+      value(directory + "/value.npy", "<f4", sizeof(float), 0),
+      outcome(directory + "/outcome.npy", "<f4", sizeof(float), 0),
+      player(directory + "/player.npy", "<i4", sizeof(int32_t), 0),
+      generation(directory + "/generation.npy", "<i4", sizeof(int32_t), 0),
+      sampling_rate(directory + "/sampling_rate.npy", "<f4", sizeof(float), 0),
+      fast_search(directory + "/fast_search.npy", "|u1", sizeof(uint8_t), 0),
+      feature_width(feature_width), policy_width(policy_width) {
+    // Each column is buffered on its own, so a crash leaves them at different lengths:
+    // resume after the last row all of them hold. Columns added to the format after the
+    // dataset was started are zero-filled for its earlier rows (no rate recorded, full
+    // searches).
+    uint64_t rows = UINT64_MAX;
+    for (NpyColumn* column : all()) {
+        if (!column->isNew()) rows = std::min(rows, column->rows());
+    }
+    for (NpyColumn* column : all()) {
+        column->resize(rows == UINT64_MAX ? 0 : rows);
+    }
+}
+
+std::vector<NpyColumn*> ColumnarWriter::PhaseColumns::all() {
+    return { &features, &policy, &value, &outcome, &player, &generation, &sampling_rate, &fast_search };
+}
+
+ColumnarWriter::ColumnarWriter(const std::string& directory)
+    : directory(prepareDirectory(directory)),
+      bidding(directory + "/bidding", FeatureEncoder::kBidFeatureCount, 14),
+      playing(directory + "/playing", FeatureEncoder::kPlayFeatureCount, 13) {
+}
+
+ColumnarWriter::~ColumnarWriter() {
+    try {
+        close();
+    }
+    catch (const std::exception&) {
+        // Nothing sensible to do from a destructor; close() reports errors to explicit callers.
+    }
+}
+
+void ColumnarWriter::appendSample(PhaseColumns& columns, const TrainingSample& sample) {
+    if (static_cast<size_t>(sample.state_features_size()) != columns.feature_width ||
+        static_cast<size_t>(sample.policy_target_size()) > columns.policy_width) {
+        skipped++;
+        return;
+    }
+    columns.features.appendRows(sample.state_features().data(), 1);
+
+    row.assign(columns.policy_width, 0.0f);
+    std::copy(sample.policy_target().begin(), sample.policy_target().end(), row.begin());
+    columns.policy.appendRows(row.data(), 1);
+
+    float value = sample.value_target();
+    float outcome = sample.actual_game_win_value();
+    int32_t player = sample.player_idx();
+    int32_t generation = sample.model_generation();
+    float sampling_rate = sample.sampling_rate();
+    uint8_t fast_search = sample.fast_search() ? 1 : 0;
+    columns.value.appendRows(&value, 1);
+    columns.outcome.appendRows(&outcome, 1);
+    columns.player.appendRows(&player, 1);
+    columns.generation.appendRows(&generation, 1);
+    columns.sampling_rate.appendRows(&sampling_rate, 1);
+    columns.fast_search.appendRows(&fast_search, 1);
+}
+
+void ColumnarWriter::writeGame(const std::vector<TrainingSample>& samples) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed) {
+        throw std::runtime_error("ColumnarWriter::writeGame called after close.");
+    }
+    for (const auto& sample : samples) {
+        appendSample(sample.is_bidding() ? bidding : playing, sample);
+    }
+}
+
+void ColumnarWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed) return;
+    closed = true;
+    for (PhaseColumns* columns : { &bidding, &playing }) {
+        for (NpyColumn* column : columns->all()) {
+            column->close();
+        }
+    }
+}
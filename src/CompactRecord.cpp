@@ -0,0 +1,156 @@
+#include "include/CompactRecord.hpp"
+#include "include/FeatureEncoder.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// True when `value` is a whole number inside [lo, hi].
+static bool integralIn(float value, int lo, int hi, int& out) {
+    if (!(value >= static_cast<float>(lo) && value <= static_cast<float>(hi)) || std::floor(value) != value) {
+        return false;
+    }
+    out = static_cast<int>(value);
+    return true;
+}
+
+static bool packCardMask(const float* bits, uint64_t& mask) {
+    mask = 0;
+    for (int i = 0; i < 52; ++i) {
+        if (bits[i] == 1.0f) {
+            mask |= uint64_t{1} << i;
+        }
+        else if (bits[i] != 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CompactCodec::encode(const TrainingSample& sample, CompactRecord& record, std::vector<CompactPolicyEntry>& policy) {
+    using namespace FeatureEncoder;
+    constexpr int kInt16Min = std::numeric_limits<int16_t>::min();
+    constexpr int kInt16Max = std::numeric_limits<int16_t>::max();
+
+    const bool bidding = sample.is_bidding();
+    const size_t width = bidding ? kBidFeatureCount : kPlayFeatureCount;
+    const size_t max_actions = bidding ? 14 : 13;
+    if (static_cast<size_t>(sample.state_features_size()) != width ||
+        static_cast<size_t>(sample.policy_target_size()) > max_actions) {
+        return false;
+    }
+
+    const float* f = sample.state_features().data();
+    record = CompactRecord{};
+    int v = 0;
+    for (int i = 0; i < 2; ++i) {
+        if (!integralIn(f[i], kInt16Min, kInt16Max, v)) return false;
+        record.scores[i] = static_cast<int16_t>(v);
+        if (!integralIn(f[2 + i], kInt16Min, kInt16Max, v)) return false;
+        record.bags[i] = static_cast<int16_t>(v);
+    }
+    for (int i = 0; i < 4; ++i) {
+        if (!integralIn(f[4 + i], -1, 13, v)) return false;
+        record.bids[i] = static_cast<int8_t>(v);
+    }
+
+    record.flags = bidding ? kCompactBidding : 0;
+    if (!bidding) {
+        if (!packCardMask(f + kPlayHandOffset, record.hand_mask) || !packCardMask(f + kPlayTrickOffset, record.trick_mask)) {
+            return false;
+        }
+        for (int i = 0; i < 4; ++i) {
+            if (!integralIn(f[kPlayTricksWonOffset + i], 0, 13, v)) return false;
+            record.tricks_won[i] = static_cast<uint8_t>(v);
+        }
+        if (!integralIn(f[kPlayTricksWonOffset + 4], 0, 1, v)) return false;
+        record.flags |= v ? kCompactSpadesBroken : 0;
+        if (!integralIn(f[kPlayTricksWonOffset + 5], 0, 3, v)) return false;
+        record.current_player = static_cast<uint8_t>(v);
+    }
+
+    record.value_target = sample.value_target();
+    record.outcome = sample.actual_game_win_value();
+    record.player_idx = static_cast<uint8_t>(sample.player_idx());
+    record.model_generation = static_cast<uint16_t>(sample.model_generation());
+    record.feature_version = static_cast<uint8_t>(sample.feature_version());
+    // 0 in the sample means it was not recorded, i.e. every decision was kept
+    const float rate = sample.sampling_rate();
+    if (rate > 0.0f && rate < 1.0f) {
+        long steps = std::lround(-kCompactSamplingRateSteps * std::log2(rate));
+        record.sampling_rate = static_cast<uint8_t>(std::clamp(steps, 0L, 255L));
+    }
+
+    // Visit counts are recovered exactly from policy * visit_total; without them (or when
+    // they overflow uint16) the probabilities are quantized to 1/65535 steps instead.
+    const int visit_total = sample.visit_total();
+    const bool exact = visit_total > 0 && visit_total <= std::numeric_limits<uint16_t>::max();
+    const float scale = exact ? static_cast<float>(visit_total) : static_cast<float>(std::numeric_limits<uint16_t>::max());
+    record.flags |= exact ? kCompactVisitCounts : 0;
+    record.flags |= sample.fast_search() ? kCompactFastSearch : 0;
+    for (int action = 0; action < sample.policy_target_size(); ++action) {
+        long count = std::lround(sample.policy_target(action) * scale);
+        if (count > 0) {
+            policy.push_back({ static_cast<uint8_t>(action), static_cast<uint16_t>(count) });
+            record.policy_entries++;
+        }
+    }
+    return true;
+}
+
+void CompactCodec::decode(const CompactRecord& record, const CompactPolicyEntry* entries, TrainingSample& sample) {
+    using namespace FeatureEncoder;
+    const bool bidding = (record.flags & kCompactBidding) != 0;
+
+    sample.Clear();
+    sample.set_is_bidding(bidding);
+    sample.set_player_idx(record.player_idx);
+    sample.set_value_target(record.value_target);
+    sample.set_actual_game_win_value(record.outcome);
+    sample.set_fast_search((record.flags & kCompactFastSearch) != 0);
+    sample.set_model_generation(record.model_generation);
+    sample.set_feature_version(record.feature_version);
+    sample.set_sampling_rate(std::exp2(-record.sampling_rate / kCompactSamplingRateSteps));
+
+    float row[kPlayFeatureCount] = {};
+    row[0] = record.scores[0];
+    row[1] = record.scores[1];
+    row[2] = record.bags[0];
+    row[3] = record.bags[1];
+    for (int i = 0; i < 4; ++i) {
+        row[4 + i] = record.bids[i];
+    }
+    if (!bidding) {
+        expandCardMask(record.hand_mask, row + kPlayHandOffset);
+        expandCardMask(record.trick_mask, row + kPlayTrickOffset);
+        for (int i = 0; i < 4; ++i) {
+            row[kPlayTricksWonOffset + i] = record.tricks_won[i];
+        }
+        row[kPlayTricksWonOffset + 4] = (record.flags & kCompactSpadesBroken) ? 1.0f : 0.0f;
+        row[kPlayTricksWonOffset + 5] = record.current_player;
+    }
+    const size_t width = bidding ? kBidFeatureCount : kPlayFeatureCount;
+    sample.mutable_state_features()->Add(row, row + width);
+
+    // Bids cover all 14 actions; playing policies cover the cards in hand.
+    int actions = 14;
+    if (!bidding) {
+        actions = 0;
+        for (uint64_t mask = record.hand_mask; mask; mask &= mask - 1) {
+            actions++;
+        }
+    }
+    uint32_t total = 0;
+    for (int i = 0; i < record.policy_entries; ++i) {
+        total += entries[i].count;
+    }
+    std::vector<float> policy(static_cast<size_t>(actions), 0.0f);
+    for (int i = 0; i < record.policy_entries; ++i) {
+        if (entries[i].action < actions && total > 0) {
+            policy[entries[i].action] = static_cast<float>(entries[i].count) / static_cast<float>(total);
+        }
+    }
+    sample.mutable_policy_target()->Add(policy.begin(), policy.end());
+    if (record.flags & kCompactVisitCounts) {
+        sample.set_visit_total(static_cast<int32_t>(total));
+    }
+}
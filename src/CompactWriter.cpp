@@ -0,0 +1,182 @@
+#include "include/CompactWriter.hpp"
+#include "include/FeatureEncoder.hpp"
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+static constexpr char kCompactMagic[8] = { 'S', 'P', 'D', 'C', 'M', 'P', '1', '\0' };
+static constexpr size_t kCompactHeaderBytes = 16;
+
+struct CompactFileHeader {
+    char magic[8];
+    uint16_t record_bytes;
+    uint16_t feature_version;
+    uint32_t reserved;
+};
+static_assert(sizeof(CompactFileHeader) == kCompactHeaderBytes, "CompactFileHeader layout is part of the file format");
+
+static bool readHeader(std::FILE* file, CompactFileHeader& header) {
+    return std::fread(&header, sizeof(header), 1, file) == 1 &&
+        std::memcmp(header.magic, kCompactMagic, sizeof(kCompactMagic)) == 0 &&
+        header.record_bytes == sizeof(CompactRecord);
+}
+
+// --- CompactWriter ---
+
+CompactWriter::CompactWriter(const std::string& path) : path(path) {
+    openForAppend();
+}
+
+CompactWriter::~CompactWriter() {
+    try {
+        close();
+    }
+    catch (const std::exception&) {
+        // Nothing sensible to do from a destructor; close() reports errors to explicit callers.
+    }
+}
+
+void CompactWriter::openForAppend() {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const std::string policy_path = policyPath(path);
+
+    if (fs::exists(path, ec) && fs::file_size(path, ec) > 0) {
+        // Keep the longest prefix of whole records whose policy entries are all present.
+        std::FILE* in = std::fopen(path.c_str(), "rb");
+        CompactFileHeader header;
+        if (!in || !readHeader(in, header)) {
+            if (in) std::fclose(in);
+            throw std::runtime_error("Not a compact data file written by this tool: " + path);
+        }
+        uint64_t policy_available = fs::exists(policy_path, ec) ? fs::file_size(policy_path, ec) / sizeof(CompactPolicyEntry) : 0;
+        uint64_t policy_used = 0;
+        std::vector<CompactRecord> chunk(4096);
+        size_t read = 0;
+        bool complete = true;
+        while (complete && (read = std::fread(chunk.data(), sizeof(CompactRecord), chunk.size(), in)) > 0) {
+            for (size_t i = 0; i < read; ++i) {
+                if (policy_used + chunk[i].policy_entries > policy_available) {
+                    complete = false;
+                    break;
+                }
+                policy_used += chunk[i].policy_entries;
+                record_count++;
+            }
+        }
+        std::fclose(in);
+        fs::resize_file(path, kCompactHeaderBytes + record_count * sizeof(CompactRecord));
+        if (fs::exists(policy_path, ec)) {
+            fs::resize_file(policy_path, policy_used * sizeof(CompactPolicyEntry));
+        }
+        record_file = std::fopen(path.c_str(), "ab");
+    }
+    else {
+        record_file = std::fopen(path.c_str(), "wb");
+        if (record_file) {
+            CompactFileHeader header{};
+            std::memcpy(header.magic, kCompactMagic, sizeof(kCompactMagic));
+            header.record_bytes = sizeof(CompactRecord);
+            header.feature_version = FeatureEncoder::kFeatureVersion;
+            if (std::fwrite(&header, sizeof(header), 1, record_file) != 1) {
+                std::fclose(record_file);
+                throw std::runtime_error("Failed to write header of " + path);
+            }
+        }
+        std::FILE* truncate = std::fopen(policy_path.c_str(), "wb");
+        if (truncate) std::fclose(truncate);
+    }
+    if (!record_file) {
+        throw std::runtime_error("Could not open data file for writing: " + path);
+    }
+    policy_file = std::fopen(policy_path.c_str(), "ab");
+    if (!policy_file) {
+        std::fclose(record_file);
+        throw std::runtime_error("Could not open data file for writing: " + policy_path);
+    }
+    std::setvbuf(record_file, nullptr, _IOFBF, 1 << 20);
+    std::setvbuf(policy_file, nullptr, _IOFBF, 1 << 18);
+}
+
+void CompactWriter::writeGame(const std::vector<TrainingSample>& samples) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed) {
+        throw std::runtime_error("CompactWriter::writeGame called after close.");
+    }
+    records_scratch.clear();
+    policy_scratch.clear();
+    for (const auto& sample : samples) {
+        CompactRecord record;
+        if (CompactCodec::encode(sample, record, policy_scratch)) {
+            records_scratch.push_back(record);
+        }
+        else {
+            skipped++;
+        }
+    }
+    // Policy first: a crash between the two writes leaves extra entries, which
+    // openForAppend trims, rather than records pointing past the policy file.
+    if (std::fwrite(policy_scratch.data(), sizeof(CompactPolicyEntry), policy_scratch.size(), policy_file) != policy_scratch.size() ||
+        std::fwrite(records_scratch.data(), sizeof(CompactRecord), records_scratch.size(), record_file) != records_scratch.size()) {
+        throw std::runtime_error("Failed to write training data to " + path);
+    }
+    record_count += records_scratch.size();
+    bytes_written += records_scratch.size() * sizeof(CompactRecord) + policy_scratch.size() * sizeof(CompactPolicyEntry);
+}
+
+void CompactWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed) return;
+    closed = true;
+    bool ok = std::fflush(policy_file) == 0;
+    ok = std::fflush(record_file) == 0 && ok;
+    std::fclose(policy_file);
+    std::fclose(record_file);
+    if (!ok) {
+        throw std::runtime_error("Failed to flush training data to " + path);
+    }
+}
+
+// --- CompactReader ---
+
+CompactReader::CompactReader(const std::string& path) {
+    record_file = std::fopen(path.c_str(), "rb");
+    CompactFileHeader header;
+    if (!record_file || !readHeader(record_file, header)) {
+        if (record_file) std::fclose(record_file);
+        throw std::runtime_error("Not a compact data file written by this tool: " + path);
+    }
+    policy_file = std::fopen(CompactWriter::policyPath(path).c_str(), "rb");
+    if (!policy_file) {
+        std::fclose(record_file);
+        throw std::runtime_error("Missing policy file " + CompactWriter::policyPath(path));
+    }
+    std::setvbuf(record_file, nullptr, _IOFBF, 1 << 20);
+    std::setvbuf(policy_file, nullptr, _IOFBF, 1 << 18);
+}
+
+CompactReader::~CompactReader() {
+    std::fclose(policy_file);
+    std::fclose(record_file);
+}
+
+bool CompactReader::next(TrainingSample& sample) {
+    CompactRecord record;
+    CompactPolicyEntry entries[14];
+    if (std::fread(&record, sizeof(record), 1, record_file) != 1 || record.policy_entries > 14 ||
+        std::fread(entries, sizeof(CompactPolicyEntry), record.policy_entries, policy_file) != record.policy_entries) {
+        return false; // End of data (or a partial tail from an interrupted write)
+    }
+    CompactCodec::decode(record, entries, sample);
+    return true;
+}
+
+bool CompactReader::isCompactFile(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    char magic[sizeof(kCompactMagic)];
+    bool match = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+        std::memcmp(magic, kCompactMagic, sizeof(kCompactMagic)) == 0;
+    std::fclose(file);
+    return match;
+}
@@ -0,0 +1,67 @@
+#include "include/Crc32c.hpp"
+#include <array>
+#include <cstring>
+
+#if defined(__SSE4_2__) || (defined(_M_X64) && defined(__AVX__))
+#include <nmmintrin.h>
+#define SPADES_CRC32C_HW 1
+#endif
+
+#ifdef SPADES_CRC32C_HW
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t state = ~crc;
+    for (; size >= 8; size -= 8, p += 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        state = _mm_crc32_u64(state, word);
+    }
+    uint32_t state32 = static_cast<uint32_t>(state);
+    for (; size > 0; --size, ++p) {
+        state32 = _mm_crc32_u8(state32, *p);
+    }
+    return ~state32;
+}
+
+#else
+
+using Crc32cTables = std::array<std::array<uint32_t, 256>, 8>;
+
+static Crc32cTables buildTables() {
+    Crc32cTables tables{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u))); // Reflected Castagnoli polynomial
+        }
+        tables[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (size_t t = 1; t < 8; ++t) {
+            tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xFF];
+        }
+    }
+    return tables;
+}
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc) {
+    static const Crc32cTables tables = buildTables();
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (; size >= 8; size -= 8, p += 8) {
+        // Little-endian: the low word is folded into the running CRC
+        uint32_t low, high;
+        std::memcpy(&low, p, sizeof(low));
+        std::memcpy(&high, p + 4, sizeof(high));
+        low ^= crc;
+        crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24] ^
+            tables[3][high & 0xFF] ^ tables[2][(high >> 8) & 0xFF] ^ tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
+    }
+    for (; size > 0; --size, ++p) {
+        crc = (crc >> 8) ^ tables[0][(crc ^ *p) & 0xFF];
+    }
+    return ~crc;
+}
+
+#endif
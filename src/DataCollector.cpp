@@ -1,110 +1,149 @@
 #include "include/DataCollector.hpp"
 #include "include/MCTSBot.hpp"
+#include "include/FeatureEncoder.hpp"
+#include "include/DataWriter.hpp"
+#include <algorithm>
 #include <stdexcept>
 
-DataCollector::DataCollector(const std::string& filepath) {
-    // Open in binary mode, as Protobuf serialization is binary
-    file.open(filepath, std::ios::binary | std::ios::app);
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open data file for writing: " + filepath);
-    }
+DataCollector::DataCollector(const std::string& filepath)
+    : writer(std::make_shared<DataWriter>(filepath)), rng(std::random_device{}()) {
+}
+
+DataCollector::DataCollector(std::shared_ptr<ISampleWriter> writer, const SamplingPolicy& sampling)
+    : writer(std::move(writer)), sampling(sampling), rng(std::random_device{}()) {
 }
 
-DataCollector::~DataCollector() {
-    if (file.is_open()) {
-        file.close();
+void DataCollector::record(const GameState& state, MCTSBot& bot, bool isBidding, bool fastSearch) {
+    int visit_total = 0;
+    for (int visits : bot.getLastVisitCounts()) {
+        visit_total += visits;
     }
+    auto value_vec = bot.getLastValueEstimate();
+    float value_target = !value_vec.empty() ? value_vec[0] : 0.5f; // 0.5 is the default without an estimate
+    recordDecision(state, isBidding, bot.getLastActionProbs(), visit_total, value_target, bot.getModelGeneration(), fastSearch);
 }
 
-void DataCollector::record(const GameState& state, MCTSBot& bot, bool isBidding) {
+void DataCollector::recordDecision(const GameState& state, bool isBidding, const std::vector<float>& policy, int visit_total,
+                                   float value_target, int model_generation, bool fastSearch) {
+    // The first bid of a round is made before anyone else has bid
+    if (isBidding && state.bidsMade == 0) {
+        closeRound();
+    }
+    decisions_seen++;
+    uint64_t sequence = game_sequence++;
+
+    // Sampling is decided before encoding, so dropped decisions cost nothing more
+    if (fastSearch && !sampling.record_fast_searches) {
+        return;
+    }
+    if (sampling.keep_probability < 1.0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng) >= sampling.keep_probability) {
+        return;
+    }
+    round_seen++;
+    size_t slot = round_buffer.size();
+    if (sampling.max_per_round > 0 && round_seen > static_cast<uint64_t>(sampling.max_per_round)) {
+        // Reservoir step: the n-th decision replaces a random kept one with probability cap / n
+        uint64_t j = std::uniform_int_distribution<uint64_t>(0, round_seen - 1)(rng);
+        if (j >= static_cast<uint64_t>(sampling.max_per_round)) {
+            return;
+        }
+        slot = static_cast<size_t>(j);
+    }
+
     // 1. Create a Protobuf message object
     TrainingSample sample;
 
     // 2. Populate the message using the generated, type-safe setters
     sample.set_is_bidding(isBidding);
     sample.set_player_idx(state.currentPlayerIndex);
+    sample.set_model_generation(model_generation);
+    sample.set_feature_version(FeatureEncoder::kFeatureVersion);
+    sample.set_fast_search(fastSearch);
 
-    std::vector<float> features = isBidding ? extractBidFeatures(state) : extractPlayFeatures(state);
-    std::vector<float> policy = bot.getLastActionProbs();
-    auto value_vec = bot.getLastValueEstimate();
-
-    // For 'repeated' fields, loop and use the 'add_*' method
-    for (float f : features) {
-        sample.add_state_features(f);
+    // Same encoder as the search, so stored features always match what the networks saw
+    if (isBidding) {
+        FeatureEncoder::encodeBid(state, feature_row);
     }
-    for (float p : policy) {
-        sample.add_policy_target(p);
+    else {
+        FeatureEncoder::encodePlay(state, feature_row);
     }
 
-    if (!value_vec.empty()) {
-        sample.set_value_target(value_vec[0]);
+    // Repeated fields: copy the encoded row and the policy in one go
+    sample.mutable_state_features()->Add(feature_row.begin(), feature_row.end());
+    sample.mutable_policy_target()->Add(policy.begin(), policy.end());
+    sample.set_visit_total(visit_total);
+    sample.set_value_target(value_target);
+
+    // 3. Add the populated object to the in-memory buffer
+    // The 'actual_game_win_value' and 'sampling_rate' will be set later in finalize()
+    PendingSample pending{ sequence, static_cast<float>(sampling.keep_probability), std::move(sample) };
+    if (slot == round_buffer.size()) {
+        round_buffer.push_back(std::move(pending));
     }
     else {
-        sample.set_value_target(0.5f); // Set a default
+        round_buffer[slot] = std::move(pending);
     }
-
-    // 3. Add the populated object to the in-memory buffer
-    // The 'actual_game_win_value' will be set later in finalize()
-    game_buffer.push_back(sample);
 }
 
-void DataCollector::finalize(int winning_team_id) {
-    for (auto& sample : game_buffer) {
-        // a. Set the final field on the buffered sample
-        int sample_player_team_id = sample.player_idx() % 2;
-        float actual_win = (sample_player_team_id == winning_team_id) ? 1.0f : 0.0f;
-        sample.set_actual_game_win_value(actual_win);
-
-        // b. Serialize the entire message object to a binary string
-        std::string serialized_data;
-        if (!sample.SerializeToString(&serialized_data)) {
-            // This is a critical error if it fails
-            throw std::runtime_error("Failed to serialize training sample.");
+// Moves the finished round's survivors on to the per-game stage.
+void DataCollector::closeRound() {
+    if (sampling.max_per_round > 0 && round_seen > static_cast<uint64_t>(sampling.max_per_round)) {
+        float round_rate = static_cast<float>(sampling.max_per_round) / static_cast<float>(round_seen);
+        for (auto& pending : round_buffer) {
+            pending.rate *= round_rate;
         }
-
-        // c. Write the data using a robust, size-delimited format
-        //    This prevents any possible misalignment during reading.
-        //    First, write the size of the message as a 4-byte integer.
-        //    Then, write the actual message data.
-        int32_t size = static_cast<int32_t>(serialized_data.size());
-        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-        file.write(serialized_data.c_str(), size);
     }
-    game_buffer.clear();
+    std::sort(round_buffer.begin(), round_buffer.end(),
+              [](const PendingSample& a, const PendingSample& b) { return a.sequence < b.sequence; });
+    for (auto& pending : round_buffer) {
+        offerToGame(std::move(pending));
+    }
+    round_buffer.clear();
+    round_seen = 0;
 }
 
+void DataCollector::offerToGame(PendingSample&& pending) {
+    game_offered++;
+    if (sampling.max_per_game <= 0 || game_buffer.size() < static_cast<size_t>(sampling.max_per_game)) {
+        game_buffer.push_back(std::move(pending));
+        return;
+    }
+    uint64_t j = std::uniform_int_distribution<uint64_t>(0, game_offered - 1)(rng);
+    if (j < game_buffer.size()) {
+        game_buffer[static_cast<size_t>(j)] = std::move(pending);
+    }
+}
 
-// --- Feature Extraction Helpers ---
-// These functions do NOT need to change. Their job is simply to generate
-// the feature vectors, which are then used to populate the Protobuf message.
+void DataCollector::finalize(int winning_team_id) {
+    closeRound();
+    float game_rate = 1.0f;
+    if (sampling.max_per_game > 0 && game_offered > static_cast<uint64_t>(sampling.max_per_game)) {
+        game_rate = static_cast<float>(sampling.max_per_game) / static_cast<float>(game_offered);
+    }
+    std::sort(game_buffer.begin(), game_buffer.end(),
+              [](const PendingSample& a, const PendingSample& b) { return a.sequence < b.sequence; });
 
-std::vector<float> DataCollector::extractBidFeatures(const GameState& state) {
-    std::vector<float> features;
-    features.push_back(static_cast<float>(state.team1Score));
-    features.push_back(static_cast<float>(state.team2Score));
-    features.push_back(static_cast<float>(state.team1Bags));
-    features.push_back(static_cast<float>(state.team2Bags));
-    for (int i = 0; i < 4; ++i) {
-        features.push_back(static_cast<float>((i < state.bidsMade) ? state.players[i].bid : -1.0f));
+    output.clear();
+    output.reserve(game_buffer.size());
+    for (auto& pending : game_buffer) {
+        TrainingSample& sample = pending.sample;
+        // Set the final field on the buffered sample
+        int sample_player_team_id = sample.player_idx() % 2;
+        float actual_win = (sample_player_team_id == winning_team_id) ? 1.0f : 0.0f;
+        sample.set_actual_game_win_value(actual_win);
+        sample.set_sampling_rate(pending.rate * game_rate);
+        output.push_back(std::move(sample));
     }
-    return features;
+    // The writer serializes the game and appends it as one size-delimited block
+    writer->writeGame(output);
+    samples_written += output.size();
+    discard();
 }
 
-std::vector<float> DataCollector::extractPlayFeatures(const GameState& state) {
-    std::vector<float> features;
-    features.push_back(static_cast<float>(state.team1Score));
-    features.push_back(static_cast<float>(state.team2Score));
-    features.push_back(static_cast<float>(state.team1Bags));
-    features.push_back(static_cast<float>(state.team2Bags));
-    for (int i = 0; i < 4; ++i) { features.push_back(static_cast<float>(state.players[i].bid)); }
-    std::vector<bool> hand_encoding(52, false);
-    for (const auto& card : state.players[state.currentPlayerIndex].hand) { hand_encoding[static_cast<int>(card.suit) * 13 + static_cast<int>(card.rank)] = true; }
-    for (bool bit : hand_encoding) { features.push_back(static_cast<float>(bit)); }
-    std::vector<bool> trick_encoding(52, false);
-    for (const auto& card : state.currentTrick) { trick_encoding[static_cast<int>(card.suit) * 13 + static_cast<int>(card.rank)] = true; }
-    for (bool bit : trick_encoding) { features.push_back(static_cast<float>(bit)); }
-    for (int i = 0; i < 4; ++i) { features.push_back(static_cast<float>(state.players[i].tricksWon)); }
-    features.push_back(static_cast<float>(state.spadesBroken ? 1.0f : 0.0f));
-    features.push_back(static_cast<float>(state.currentPlayerIndex));
-    return features;
-}
\ No newline at end of file
+void DataCollector::discard() {
+    round_buffer.clear();
+    round_seen = 0;
+    game_buffer.clear();
+    game_offered = 0;
+    game_sequence = 0;
+}
@@ -0,0 +1,252 @@
+#include "include/DataWriter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <new>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static constexpr size_t kBlockAlignment = 4096;
+
+DataWriter::DataWriter(const std::string& filepath, const DataWriterOptions& options)
+    : path(filepath), options(options), queue(std::max<size_t>(options.queue_capacity, 2)) {
+    if (options.write_index) {
+        // Continue the existing index, rebuilding it first if it is missing or stale.
+        // A rebuild stops at a torn last record, which is dropped so that appended
+        // games stay readable.
+        std::error_code ec;
+        data_offset = std::filesystem::exists(filepath, ec) ? std::filesystem::file_size(filepath, ec) : 0;
+        SampleIndexEntry last{};
+        if (data_offset > 0 && !SampleIndex::isCurrent(filepath, &last)) {
+            uint64_t indexed_bytes = 0;
+            SampleIndex::rebuild(filepath, &indexed_bytes);
+            if (indexed_bytes < data_offset) {
+                std::filesystem::resize_file(filepath, indexed_bytes);
+                data_offset = indexed_bytes;
+            }
+            if (data_offset > 0 && !SampleIndex::isCurrent(filepath, &last)) {
+                throw std::runtime_error("Could not rebuild the index of " + filepath);
+            }
+        }
+        if (data_offset == 0) {
+            std::filesystem::remove(SampleIndex::pathFor(filepath), ec);
+        }
+        else {
+            next_game_id = last.game_id + 1; // Game ids never decrease along the file
+        }
+        index = std::make_unique<SampleIndexAppender>(filepath);
+    }
+
+    // Open in binary append mode, as Protobuf serialization is binary. Buffering is
+    // done in our own blocks, so the stdio buffer is turned off.
+    file = std::fopen(filepath.c_str(), "ab");
+    if (!file) {
+        throw std::runtime_error("Could not open data file for writing: " + filepath);
+    }
+    std::setvbuf(file, nullptr, _IONBF, 0);
+
+    this->options.block_bytes = std::max<size_t>(options.block_bytes, kBlockAlignment);
+    block = static_cast<char*>(::operator new(this->options.block_bytes, std::align_val_t(kBlockAlignment)));
+    writer_thread = std::thread(&DataWriter::writerLoop, this);
+}
+
+DataWriter::~DataWriter() {
+    try {
+        close();
+    }
+    catch (const std::exception&) {
+        // Errors were already reported through writeGame/close; nothing left to do here.
+    }
+    ::operator delete(block, std::align_val_t(kBlockAlignment));
+}
+
+void DataWriter::writeGame(const std::vector<TrainingSample>& samples) {
+    PendingGame game;
+    std::string& game_block = game.bytes;
+    std::string serialized_data;
+    game.is_bidding.reserve(samples.size());
+    for (const auto& sample : samples) {
+        game.is_bidding.push_back(sample.is_bidding() ? 1 : 0);
+        if (!sample.SerializeToString(&serialized_data)) {
+            // This is a critical error if it fails
+            throw std::runtime_error("Failed to serialize training sample.");
+        }
+        // Size-delimited: the message size as a 4-byte integer, then the message data.
+        int32_t size = static_cast<int32_t>(serialized_data.size());
+        game_block.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        game_block.append(serialized_data);
+    }
+
+    if (!queue.tryPush(std::move(game))) {
+        // Backpressure: the writer is behind. Wait for space and account for the stall.
+        auto start = std::chrono::steady_clock::now();
+        producer_stalls.fetch_add(1, std::memory_order_relaxed);
+        while (!queue.tryPush(std::move(game))) {
+            if (failed.load(std::memory_order_acquire)) break;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        producer_stall_ns.fetch_add(static_cast<uint64_t>(waited.count()), std::memory_order_relaxed);
+    }
+    if (failed.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        throw std::runtime_error(error_message);
+    }
+
+    size_t depth = queue.sizeApprox();
+    size_t seen = max_queue_depth.load(std::memory_order_relaxed);
+    while (depth > seen && !max_queue_depth.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {
+    }
+}
+
+void DataWriter::writerLoop() {
+    PendingGame game;
+    const std::string& game_block = game.bytes;
+    int idle_polls = 0;
+    auto last_flush = std::chrono::steady_clock::now();
+    while (!failed.load(std::memory_order_acquire)) {
+        // Read the flag before popping: close() sets it after the last producer returned,
+        // so an empty pop that follows a set flag means the queue is fully drained.
+        bool stopping = stop_requested.load(std::memory_order_acquire);
+        if (!queue.tryPop(game)) {
+            if (stopping) {
+                break;
+            }
+            // Idle: push out a partial block once a second so a slow run still makes progress on disk.
+            if (block_used > 0 && std::chrono::steady_clock::now() - last_flush > std::chrono::seconds(1)) {
+                flushBlock();
+                last_flush = std::chrono::steady_clock::now();
+            }
+            if (++idle_polls < 64) {
+                std::this_thread::yield();
+            }
+            else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            continue;
+        }
+        idle_polls = 0;
+        games.fetch_add(1, std::memory_order_relaxed);
+
+        const char* data = game_block.data();
+        size_t remaining = game_block.size();
+        while (remaining > 0) {
+            size_t chunk = std::min(remaining, options.block_bytes - block_used);
+            std::memcpy(block + block_used, data, chunk);
+            block_used += chunk;
+            data += chunk;
+            remaining -= chunk;
+            if (block_used == options.block_bytes) {
+                flushBlock();
+                last_flush = std::chrono::steady_clock::now();
+            }
+        }
+
+        if (index) {
+            // Record offsets follow from the length prefixes inside the game block
+            size_t position = 0;
+            for (uint8_t is_bidding : game.is_bidding) {
+                SampleIndexEntry entry{};
+                entry.offset = data_offset + position;
+                entry.game_id = next_game_id;
+                entry.is_bidding = is_bidding;
+                pending_index.push_back(entry);
+                int32_t size = 0;
+                std::memcpy(&size, game_block.data() + position, sizeof(size));
+                position += sizeof(size) + static_cast<size_t>(size);
+            }
+            data_offset += game_block.size();
+            next_game_id++;
+        }
+    }
+    if (!failed.load(std::memory_order_acquire)) {
+        flushBlock();
+        flushIndex(); // Entries of a game that ended exactly on a block boundary
+        if (options.sync_every_bytes > 0) syncFile();
+    }
+}
+
+void DataWriter::flushBlock() {
+    if (block_used == 0) return;
+    if (std::fwrite(block, 1, block_used, file) != block_used) {
+        fail("Failed to write training data to " + path + ".");
+        return;
+    }
+    flushIndex();
+    bytes_written.fetch_add(block_used, std::memory_order_relaxed);
+    blocks_written.fetch_add(1, std::memory_order_relaxed);
+    bytes_since_sync += block_used;
+    block_used = 0;
+    if (options.sync_every_bytes > 0 && bytes_since_sync >= options.sync_every_bytes) {
+        syncFile();
+    }
+}
+
+// Only called once every record of pending_index has been handed to fwrite.
+void DataWriter::flushIndex() {
+    if (!index || pending_index.empty()) return;
+    if (!index->append(pending_index)) {
+        fail("Failed to write index " + SampleIndex::pathFor(path) + ".");
+        return;
+    }
+    pending_index.clear();
+}
+
+void DataWriter::syncFile() {
+    if (bytes_since_sync == 0) return;
+#ifdef _WIN32
+    int result = _commit(_fileno(file));
+#elif defined(__APPLE__)
+    int result = fsync(fileno(file));
+#else
+    int result = fdatasync(fileno(file));
+#endif
+    if (result != 0) {
+        fail("Failed to sync training data file " + path + ".");
+        return;
+    }
+    bytes_since_sync = 0;
+    syncs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void DataWriter::fail(const std::string& message) {
+    std::lock_guard<std::mutex> lock(error_mutex);
+    error_message = message;
+    failed.store(true, std::memory_order_release);
+}
+
+void DataWriter::close() {
+    std::call_once(close_once, [this] {
+        stop_requested.store(true, std::memory_order_release);
+        if (writer_thread.joinable()) {
+            writer_thread.join();
+        }
+        std::fclose(file);
+        file = nullptr;
+        if (index && !index->close()) {
+            fail("Failed to write index " + SampleIndex::pathFor(path) + ".");
+        }
+    });
+    if (failed.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        throw std::runtime_error(error_message);
+    }
+}
+
+DataWriterStats DataWriter::stats() const {
+    DataWriterStats result;
+    result.games = games.load(std::memory_order_relaxed);
+    result.bytes_written = bytes_written.load(std::memory_order_relaxed);
+    result.blocks_written = blocks_written.load(std::memory_order_relaxed);
+    result.syncs = syncs.load(std::memory_order_relaxed);
+    result.producer_stalls = producer_stalls.load(std::memory_order_relaxed);
+    result.producer_stall_ms = producer_stall_ns.load(std::memory_order_relaxed) / 1e6;
+    result.max_queue_depth = max_queue_depth.load(std::memory_order_relaxed);
+    return result;
+}
@@ -0,0 +1,497 @@
+#include "include/DoubleDummy.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static constexpr uint64_t kSuitBits = (uint64_t{1} << 13) - 1;
+static constexpr int kSpades = 3;
+static constexpr uint64_t kSpadeMask = kSuitBits << (kSpades * 13);
+
+static inline int popCount(uint64_t mask) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<int>(__popcnt64(mask));
+#elif defined(__GNUC__)
+    return __builtin_popcountll(mask);
+#else
+    int count = 0;
+    for (; mask; mask &= mask - 1) ++count;
+    return count;
+#endif
+}
+
+// Index of the highest set bit; mask must not be 0
+static inline int highBit(uint64_t mask) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, mask);
+    return static_cast<int>(index);
+#elif defined(__GNUC__)
+    return 63 - __builtin_clzll(mask);
+#else
+    int index = 0;
+    while (mask >>= 1) ++index;
+    return index;
+#endif
+}
+
+// Index of the lowest set bit; mask must not be 0
+static inline int lowBit(uint64_t mask) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<int>(index);
+#elif defined(__GNUC__)
+    return __builtin_ctzll(mask);
+#else
+    int index = 0;
+    while (!(mask & 1)) { mask >>= 1; ++index; }
+    return index;
+#endif
+}
+
+static inline uint64_t suitBits(uint64_t mask, int suit) {
+    return (mask >> (suit * 13)) & kSuitBits;
+}
+
+static inline uint64_t suitOf(int card) {
+    return kSuitBits << (card / 13 * 13);
+}
+
+static inline uint64_t cardBits(const std::vector<Card>& cards) {
+    uint64_t mask = 0;
+    for (const Card& card : cards) {
+        mask |= uint64_t{1} << (static_cast<int>(card.suit) * 13 + static_cast<int>(card.rank));
+    }
+    return mask;
+}
+
+// True when `card` beats the trick's current winner `best`
+static inline bool beats(int card, int best) {
+    int suit = card / 13, best_suit = best / 13;
+    return suit == best_suit ? card > best : suit == kSpades;
+}
+
+DoubleDummySolver::DoubleDummySolver(size_t max_entries) : max_entries(max_entries) {}
+
+void DoubleDummySolver::clear() {
+    table.clear();
+    entry_count = 0;
+}
+
+DoubleDummySolver::Position DoubleDummySolver::fromState(const GameState& state) {
+    Position pos;
+    for (int p = 0; p < 4; ++p) {
+        pos.hands[p] = cardBits(state.players[p].hand);
+    }
+    for (const Card& card : state.currentTrick) {
+        int index = static_cast<int>(card.suit) * 13 + static_cast<int>(card.rank);
+        pos.trick_cards[pos.trick_size++] = index;
+        pos.trick_mask |= uint64_t{1} << index;
+    }
+    pos.leader = state.currentTrick.empty() ? state.currentPlayerIndex : state.trickLeaderIndex;
+    pos.player = state.currentPlayerIndex;
+    pos.broken = state.spadesBroken;
+    int cards = pos.trick_size;
+    for (uint64_t hand : pos.hands) cards += popCount(hand);
+    if (cards % 4 != 0) {
+        throw std::runtime_error("DoubleDummySolver: hands do not form a playable position.");
+    }
+    return pos;
+}
+
+int DoubleDummySolver::remainingTricks(const Position& pos) {
+    return popCount(pos.hands[pos.leader]) + (pos.trick_size > 0 ? 1 : 0);
+}
+
+// Cards of pos.player that may be played now
+uint64_t DoubleDummySolver::legalMoves(const Position& pos) {
+    uint64_t hand = pos.hands[pos.player];
+    if (pos.trick_size == 0) {
+        uint64_t side_suits = hand & ~kSpadeMask;
+        return (!pos.broken && side_suits) ? side_suits : hand;
+    }
+    uint64_t follow = hand & suitOf(pos.trick_cards[0]);
+    return follow ? follow : hand;
+}
+
+void DoubleDummySolver::play(Position& pos, int card) {
+    uint64_t bit = uint64_t{1} << card;
+    pos.hands[pos.player] &= ~bit;
+    pos.trick_mask |= bit;
+    pos.trick_cards[pos.trick_size++] = card;
+    pos.broken = pos.broken || card / 13 == kSpades;
+    if (pos.trick_size < 4) {
+        pos.player = (pos.player + 1) % 4;
+        return;
+    }
+    int best = 0;
+    for (int i = 1; i < 4; ++i) {
+        if (beats(pos.trick_cards[i], pos.trick_cards[best])) best = i;
+    }
+    pos.leader = (pos.leader + best) % 4;
+    pos.player = pos.leader;
+    pos.trick_size = 0;
+    pos.trick_mask = 0;
+}
+
+// Fills `moves` with one card per class of equivalent legal cards, likeliest best
+// first, and returns how many. The heuristics only order the search; results do not
+// depend on them.
+int DoubleDummySolver::orderedMoves(const Position& pos, int* moves) const {
+    uint64_t hand = pos.hands[pos.player];
+    uint64_t live = pos.trick_mask;
+    for (int p = 0; p < 4; ++p) {
+        if (p != pos.player) live |= pos.hands[p];
+    }
+
+    int winner_card = -1;
+    bool partner_winning = false;
+    if (pos.trick_size > 0) {
+        int best = 0;
+        for (int i = 1; i < pos.trick_size; ++i) {
+            if (beats(pos.trick_cards[i], pos.trick_cards[best])) best = i;
+        }
+        winner_card = pos.trick_cards[best];
+        partner_winning = (pos.leader + best) % 2 == pos.player % 2;
+    }
+
+    int scores[13];
+    int count = 0;
+    for (uint64_t legal = legalMoves(pos); legal; legal &= legal - 1) {
+        int card = lowBit(legal);
+        uint64_t suit = suitOf(card);
+        // Only the lowest card of a run that no live card splits is searched
+        uint64_t below = (hand | live) & suit & ((uint64_t{1} << card) - 1);
+        if (below && !(live >> highBit(below) & 1)) continue;
+
+        int rank = card % 13;
+        int score;
+        if (pos.trick_size == 0) {
+            bool top = (live & suit & ~((uint64_t{2} << card) - 1)) == 0;
+            score = top ? 100 + rank : 50 - rank - (card / 13 == kSpades ? 13 : 0); // Cash winners, else lead low side suits
+        }
+        else if (partner_winning) {
+            score = 50 - rank; // Let partner's card stand
+        }
+        else if (beats(card, winner_card)) {
+            score = 100 - rank; // Cheapest card that takes the lead
+        }
+        else {
+            score = 50 - rank - (card / 13 == kSpades ? 13 : 0); // Lowest discard, keeping spades
+        }
+
+        int i = count++;
+        for (; i > 0 && scores[i - 1] < score; --i) {
+            scores[i] = scores[i - 1];
+            moves[i] = moves[i - 1];
+        }
+        scores[i] = score;
+        moves[i] = card;
+    }
+    return count;
+}
+
+DoubleDummySolver::Key DoubleDummySolver::makeKey(const Position& pos) {
+    // At a trick boundary every hand holds as many cards, so the last hand's spade
+    // count follows from the rest and its place goes to the leader and spades broken
+    Key key{ 0, { 0, 0, 0, 0 } };
+    for (int i = 0; i < 15; ++i) {
+        key.shape |= static_cast<uint64_t>(popCount(suitBits(pos.hands[i / 4], i % 4))) << (i * 4);
+    }
+    key.shape |= static_cast<uint64_t>(pos.leader | (pos.broken ? 4 : 0)) << 60;
+    uint64_t all = pos.hands[0] | pos.hands[1] | pos.hands[2] | pos.hands[3];
+    for (int suit = 0; suit < 4; ++suit) {
+        uint64_t cards = all & (kSuitBits << (suit * 13));
+        for (int bit = 0; cards; bit += 2) {
+            uint64_t card = uint64_t{1} << highBit(cards);
+            uint32_t owner = (pos.hands[1] & card ? 1 : 0) | (pos.hands[2] & card ? 2 : 0) | (pos.hands[3] & card ? 3 : 0);
+            key.owners[suit] |= owner << bit;
+            cards &= ~card;
+        }
+    }
+    return key;
+}
+
+bool DoubleDummySolver::matches(const Entry& entry, const Key& key) {
+    return (key.owners[0] & entry.kept[0]) == entry.owners[0] && (key.owners[1] & entry.kept[1]) == entry.owners[1] &&
+        (key.owners[2] & entry.kept[2]) == entry.owners[2] && (key.owners[3] & entry.kept[3]) == entry.owners[3];
+}
+
+void DoubleDummySolver::store(const Key& key, uint64_t relevant_cards, uint64_t all, int lower, int upper, int lead) {
+    Entry entry{ { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, static_cast<int8_t>(lower), static_cast<int8_t>(upper),
+                 static_cast<uint8_t>(lead < 0 ? 0xFF : lead) };
+    for (int suit = 0; suit < 4; ++suit) {
+        uint64_t decided = relevant_cards & (kSuitBits << (suit * 13));
+        if (!decided) continue;
+        // Every card out from the top of the suit down to the lowest that decided a trick
+        int count = popCount(all & (kSuitBits << (suit * 13)) & ~((uint64_t{1} << lowBit(decided)) - 1));
+        entry.kept[suit] = (uint32_t{1} << (2 * count)) - 1;
+        entry.owners[suit] = key.owners[suit] & entry.kept[suit];
+    }
+
+    std::vector<Entry>& entries = table[key.shape];
+    for (Entry& slot : entries) {
+        if (slot.kept == entry.kept && slot.owners == entry.owners) {
+            // Same set of positions: both bounds hold
+            slot.lower = std::max(slot.lower, entry.lower);
+            slot.upper = std::min(slot.upper, entry.upper);
+            if (lead >= 0) slot.lead = entry.lead;
+            return;
+        }
+    }
+    if (entry_count >= max_entries) {
+        table.clear();
+        entry_count = 0;
+    }
+    table[key.shape].push_back(entry);
+    entry_count++;
+}
+
+// Tricks each team is sure of at a trick boundary. A spade above all of the other
+// side's spades wins whichever trick it is played to, and the cards of one hand go
+// to different tricks. The leader can also cash the top cards of a side suit for as
+// many rounds as everyone else holding spades still follows. `relevant` receives the
+// highest card each count was measured against.
+void DoubleDummySolver::sureTricks(const Position& pos, int& team0, int& team1, uint64_t& relevant) {
+    uint64_t spades[4];
+    for (int p = 0; p < 4; ++p) {
+        spades[p] = pos.hands[p] & kSpadeMask;
+    }
+    int sure[2];
+    for (int team = 0; team < 2; ++team) {
+        uint64_t theirs = spades[1 - team] | spades[3 - team];
+        uint64_t above = ~uint64_t{0};
+        if (theirs) {
+            above = ~((uint64_t{2} << highBit(theirs)) - 1);
+            relevant |= uint64_t{1} << highBit(theirs);
+        }
+        sure[team] = std::max(popCount(spades[team] & above), popCount(spades[team + 2] & above));
+    }
+
+    int leader = pos.leader;
+    uint64_t leader_hand = pos.hands[leader];
+    uint64_t others = 0;
+    for (int p = 0; p < 4; ++p) {
+        if (p != leader) others |= pos.hands[p];
+    }
+    uint64_t their_spades = spades[(leader + 1) % 4] | spades[(leader + 3) % 4];
+    uint64_t top_spades = their_spades ? ~((uint64_t{2} << highBit(their_spades)) - 1) : ~uint64_t{0};
+    int cashable = popCount(spades[leader] & top_spades);
+    for (int suit = 0; suit < 3; ++suit) {
+        uint64_t mine = suitBits(leader_hand, suit);
+        uint64_t rest = suitBits(others, suit);
+        // Top cards in a row: mine above the highest card anyone else holds in the suit
+        int winners = popCount(mine);
+        if (rest) {
+            winners = popCount(mine & ~((uint64_t{2} << highBit(rest)) - 1));
+            if (winners > 0) relevant |= uint64_t{1} << (suit * 13 + highBit(rest));
+        }
+        for (int other = 1; other < 4; ++other) {
+            // Partner's ruff would win the trick too, but hand the lead away
+            int player = (leader + other) % 4;
+            if (spades[player]) {
+                winners = std::min(winners, popCount(suitBits(pos.hands[player], suit)));
+            }
+        }
+        cashable += winners;
+    }
+    sure[leader % 2] = std::max(sure[leader % 2], cashable);
+    team0 = sure[0];
+    team1 = sure[1];
+}
+
+// The winner of a completed trick when it beat another card of its own suit, else 0:
+// a trick taken by the only card of its suit is decided by the suit lengths alone.
+static inline uint64_t rankWinner(const std::array<int, 4>& cards) {
+    int best = 0;
+    for (int i = 1; i < 4; ++i) {
+        if (beats(cards[i], cards[best])) best = i;
+    }
+    for (int i = 0; i < 4; ++i) {
+        if (i != best && cards[i] / 13 == cards[best] / 13) return uint64_t{1} << cards[best];
+    }
+    return 0;
+}
+
+bool DoubleDummySolver::search(const Position& pos, int target, uint64_t& relevant) {
+    node_count++;
+    relevant = 0;
+    int remaining = remainingTricks(pos);
+    if (target <= 0) return true;
+    if (target > remaining) return false;
+
+    if (remaining == 1 && pos.trick_size == 0) {
+        // Last trick: every card is forced
+        Position last = pos;
+        for (int i = 0; i < 4; ++i) {
+            play(last, lowBit(last.hands[last.player]));
+        }
+        relevant = rankWinner(last.trick_cards);
+        return (last.leader % 2 == 0 ? 1 : 0) >= target;
+    }
+
+    bool boundary = pos.trick_size == 0;
+    Key key;
+    int lead = -1;
+    uint64_t all = pos.hands[0] | pos.hands[1] | pos.hands[2] | pos.hands[3];
+    if (boundary) {
+        int sure0, sure1;
+        uint64_t sure_relevant = 0;
+        sureTricks(pos, sure0, sure1, sure_relevant);
+        if (sure0 >= target || remaining - sure1 < target) {
+            relevant = sure_relevant;
+            return sure0 >= target;
+        }
+
+        key = makeKey(pos);
+        auto found = table.find(key.shape);
+        for (size_t i = 0; found != table.end() && i < found->second.size(); ++i) {
+            const Entry& hit = found->second[i];
+            if (!matches(hit, key)) continue;
+            // Bounds are stored for the leader's team; turn them into team 0's
+            int lower0 = pos.leader % 2 == 0 ? hit.lower : remaining - hit.upper;
+            int upper0 = pos.leader % 2 == 0 ? hit.upper : remaining - hit.lower;
+            if (lower0 >= target || upper0 < target) {
+                for (int suit = 0; suit < 4; ++suit) {
+                    // The entry stands on the cards it kept: the top ones of each suit
+                    uint64_t cards = all & (kSuitBits << (suit * 13));
+                    for (int n = popCount(hit.kept[suit]) / 2; n > 0; --n) {
+                        relevant |= uint64_t{1} << highBit(cards);
+                        cards &= ~(uint64_t{1} << highBit(cards));
+                    }
+                }
+                return lower0 >= target;
+            }
+            if (hit.lead != 0xFF && lead < 0) {
+                // Back from relative rank to the card: the n-th highest still out in the suit
+                uint64_t suit_cards = all & (kSuitBits << (hit.lead / 16 * 13));
+                for (int above = hit.lead % 16; above > 0 && suit_cards; --above) {
+                    suit_cards &= ~(uint64_t{1} << highBit(suit_cards));
+                }
+                lead = suit_cards ? highBit(suit_cards) : -1;
+            }
+        }
+    }
+
+    int moves[13];
+    int count = orderedMoves(pos, moves);
+    for (int i = 1; i < count && lead >= 0; ++i) {
+        if (moves[i] == lead) {
+            std::rotate(moves, moves + i, moves + i + 1); // The stored refutation goes first
+            break;
+        }
+    }
+    bool maximizing = pos.player % 2 == 0;
+    bool result = !maximizing;
+    int refutation = -1;
+    for (int i = 0; i < count; ++i) {
+        Position child = pos;
+        play(child, moves[i]);
+        // A trick completed by this card lowers the target when team 0 won it
+        bool completed = child.trick_size == 0;
+        bool team0_won = completed && child.leader % 2 == 0;
+        uint64_t child_relevant;
+        bool child_result = search(child, target - (team0_won ? 1 : 0), child_relevant);
+        if (completed) child_relevant |= rankWinner(child.trick_cards);
+        if (child_result == maximizing) {
+            // One line proves the result: only what decided it counts
+            result = maximizing;
+            refutation = moves[i];
+            relevant = child_relevant;
+            break;
+        }
+        relevant |= child_relevant;
+    }
+
+    if (boundary) {
+        bool leader_team0 = pos.leader % 2 == 0;
+        int lower = 0, upper = remaining; // For the leader's team
+        if (result) { // Team 0 takes >= target
+            if (leader_team0) lower = target;
+            else upper = remaining - target;
+        }
+        else {        // Team 0 takes <= target - 1
+            if (leader_team0) upper = target - 1;
+            else lower = remaining - target + 1;
+        }
+        int stored_lead = -1;
+        if (refutation >= 0) {
+            int suit = refutation / 13;
+            stored_lead = suit * 16 + popCount(all & (kSuitBits << (suit * 13)) & ~((uint64_t{2} << refutation) - 1));
+        }
+        store(key, relevant, all, lower, upper, stored_lead);
+    }
+    return result;
+}
+
+// Largest n such that team 0 takes n of the remaining tricks, by bisection over
+// null-window probes that share the table.
+int DoubleDummySolver::tricksForTeam0(const Position& pos) {
+    int low = 0, high = remainingTricks(pos);
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        uint64_t relevant;
+        if (search(pos, mid, relevant)) low = mid;
+        else high = mid - 1;
+    }
+    return low;
+}
+
+std::array<int, 2> DoubleDummySolver::solve(const GameState& state) {
+    Position pos = fromState(state);
+    int remaining = remainingTricks(pos);
+    if (remaining == 0) return { 0, 0 };
+    int team0 = tricksForTeam0(pos);
+    return { team0, remaining - team0 };
+}
+
+std::vector<int> DoubleDummySolver::solveMoves(const GameState& state) {
+    Position pos = fromState(state);
+    const auto& hand = state.players[pos.player].hand;
+    int team = pos.player % 2;
+    int remaining = remainingTricks(pos);
+
+    // No card does better than the position's value, and most do as well or one worse:
+    // probe each downwards from there rather than bisecting it from scratch
+    int team0_best = tricksForTeam0(pos);
+    int best = team == 0 ? team0_best : remaining - team0_best;
+    int moves[13];
+    int count = orderedMoves(pos, moves);
+    std::array<int, 52> card_tricks;
+    card_tricks.fill(-1);
+    for (int i = 0; i < count; ++i) {
+        Position child = pos;
+        play(child, moves[i]);
+        int won0 = child.trick_size == 0 && child.leader % 2 == 0 ? 1 : 0;
+        int tricks = best;
+        for (; tricks > 0; --tricks) {
+            // Does the mover's team take `tricks` after this card?
+            uint64_t relevant;
+            bool takes = team == 0 ? search(child, tricks - won0, relevant)
+                                   : !search(child, remaining - tricks - won0 + 1, relevant);
+            if (takes) break;
+        }
+        card_tricks[moves[i]] = tricks;
+    }
+
+    // Equivalent cards take what the card searched for their class takes
+    uint64_t legal = legalMoves(pos);
+    uint64_t live = pos.trick_mask;
+    for (int p = 0; p < 4; ++p) {
+        if (p != pos.player) live |= pos.hands[p];
+    }
+    std::vector<int> result(hand.size(), -1);
+    for (size_t i = 0; i < hand.size(); ++i) {
+        int card = static_cast<int>(hand[i].suit) * 13 + static_cast<int>(hand[i].rank);
+        if (!(legal >> card & 1)) continue;
+        int searched = card;
+        while (card_tricks[searched] < 0) {
+            searched = highBit((pos.hands[pos.player] | live) & suitOf(card) & ((uint64_t{1} << searched) - 1));
+        }
+        result[i] = card_tricks[searched];
+    }
+    return result;
+}
@@ -0,0 +1,95 @@
+#include "include/FeatureEncoder.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FEATUREENCODER_SSE2 1
+#endif
+
+uint64_t FeatureEncoder::cardMask(const std::vector<Card>& cards) {
+    uint64_t mask = 0;
+    for (const Card& card : cards) {
+        mask |= uint64_t{1} << cardIndex(card);
+    }
+    return mask;
+}
+
+#ifdef FEATUREENCODER_SSE2
+// Four float lanes for every 4-bit nibble value; 52 cards are exactly 13 nibbles.
+struct NibbleLanes {
+    alignas(16) float lanes[16][4];
+    NibbleLanes() {
+        for (int nibble = 0; nibble < 16; ++nibble) {
+            for (int bit = 0; bit < 4; ++bit) {
+                lanes[nibble][bit] = (nibble >> bit) & 1 ? 1.0f : 0.0f;
+            }
+        }
+    }
+};
+static const NibbleLanes nibble_lanes;
+#endif
+
+void FeatureEncoder::expandCardMask(uint64_t mask, float* out) {
+#ifdef FEATUREENCODER_SSE2
+    for (int nibble = 0; nibble < 13; ++nibble) {
+        _mm_storeu_ps(out + nibble * 4, _mm_load_ps(nibble_lanes.lanes[(mask >> (nibble * 4)) & 0xF]));
+    }
+#else
+    for (int i = 0; i < 52; ++i) {
+        out[i] = static_cast<float>((mask >> i) & 1);
+    }
+#endif
+}
+
+// Scores and bags, common prefix of the bidding and playing layouts.
+static void encodeScores(const GameState& state, float* row) {
+    row[0] = static_cast<float>(state.team1Score);
+    row[1] = static_cast<float>(state.team2Score);
+    row[2] = static_cast<float>(state.team1Bags);
+    row[3] = static_cast<float>(state.team2Bags);
+}
+
+void FeatureEncoder::encodeBid(const GameState& state, float* row) {
+    encodeScores(state, row);
+    for (int i = 0; i < 4; ++i) {
+        row[4 + i] = (i < state.bidsMade) ? static_cast<float>(state.players[i].bid) : -1.0f;
+    }
+}
+
+void FeatureEncoder::encodePlay(const GameState& state, float* row) {
+    encodeScores(state, row);
+    for (int i = 0; i < 4; ++i) {
+        row[4 + i] = static_cast<float>(state.players[i].bid);
+    }
+    expandCardMask(cardMask(state.players[state.currentPlayerIndex].hand), row + kPlayHandOffset);
+    expandCardMask(cardMask(state.currentTrick), row + kPlayTrickOffset);
+    for (int i = 0; i < 4; ++i) {
+        row[kPlayTricksWonOffset + i] = static_cast<float>(state.players[i].tricksWon);
+    }
+    row[kPlayTricksWonOffset + 4] = state.spadesBroken ? 1.0f : 0.0f;
+    row[kPlayTricksWonOffset + 5] = static_cast<float>(state.currentPlayerIndex);
+}
+
+void FeatureEncoder::encodeValue(const GameState& state, int perspective_player_idx, float* row) {
+    bool team1 = perspective_player_idx % 2 == 0;
+    float team_score = static_cast<float>(team1 ? state.team1Score : state.team2Score);
+    float other_team_score = static_cast<float>(team1 ? state.team2Score : state.team1Score);
+    row[0] = team_score + other_team_score;
+    row[1] = team_score - other_team_score;
+    row[2] = static_cast<float>(team1 ? state.team1Bags : state.team2Bags);
+    row[3] = static_cast<float>(team1 ? state.team2Bags : state.team1Bags);
+}
+
+void FeatureEncoder::encodeBid(const GameState& state, std::vector<float>& row) {
+    row.resize(kBidFeatureCount);
+    encodeBid(state, row.data());
+}
+
+void FeatureEncoder::encodePlay(const GameState& state, std::vector<float>& row) {
+    row.resize(kPlayFeatureCount);
+    encodePlay(state, row.data());
+}
+
+void FeatureEncoder::encodeValue(const GameState& state, int perspective_player_idx, std::vector<float>& row) {
+    row.resize(kValueFeatureCount);
+    encodeValue(state, perspective_player_idx, row.data());
+}
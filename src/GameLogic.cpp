@@ -1,5 +1,6 @@
 #include "include/GameLogic.hpp"
 #include <algorithm>
+#include <cstdint>
 #include <chrono>
 #include <random>
 #include <numeric> // For std::accumulate
@@ -24,6 +25,10 @@ void GameLogic::shuffleDeck(std::vector<Card>& deck) {
     std::shuffle(deck.begin(), deck.end(), std::default_random_engine(seed));
 }
 
+void GameLogic::shuffleDeck(std::vector<Card>& deck, std::mt19937& rng) {
+    std::shuffle(deck.begin(), deck.end(), rng);
+}
+
 void GameLogic::dealCards(GameState& state) {
     // Clear hands first to be safe
     for (auto& player : state.players) {
@@ -237,36 +242,209 @@ bool GameLogic::isRoundOver(const GameState& state) {
     return totalTricksWon >= 13;
 }
 
+// --- Claims ---
+// Card bitmasks use bit suit * 13 + rank (as FeatureEncoder::cardMask), so within a
+// suit a higher bit is a higher card.
+static constexpr uint64_t kSuitBits = (uint64_t{1} << 13) - 1;
+static constexpr int kSpades = static_cast<int>(Suit::SPADES);
+static constexpr uint64_t kSpadeMask = kSuitBits << (kSpades * 13);
+
+static uint64_t cardBits(const std::vector<Card>& cards) {
+    uint64_t mask = 0;
+    for (const Card& card : cards) {
+        mask |= uint64_t{1} << (static_cast<int>(card.suit) * 13 + static_cast<int>(card.rank));
+    }
+    return mask;
+}
+
+static uint64_t suitBits(uint64_t mask, int suit) {
+    return (mask >> (suit * 13)) & kSuitBits;
+}
+
+static int bitCount(uint64_t mask) {
+    int count = 0;
+    for (; mask; mask &= mask - 1) ++count;
+    return count;
+}
+
+static int bitIndex(uint64_t single_bit) {
+    int index = 0;
+    while (single_bit >>= 1) ++index;
+    return index;
+}
+
+// True when every card of `ours` outranks every card of `theirs` (both bits of one suit)
+static bool outranks(uint64_t ours, uint64_t theirs) {
+    return ours == 0 || theirs < (ours & (~ours + 1));
+}
+
 bool GameLogic::canTram(const GameState& state) {
-    const auto& currentPlayer = state.players[state.currentPlayerIndex];
-    const auto& hand = currentPlayer.hand;
+    const auto& hand = state.players[state.currentPlayerIndex].hand;
     int totalTricksWonByAll = 0;
     for(const auto& p : state.players) {
         totalTricksWonByAll += p.tricksWon;
     }
     int remainingTricks = 13 - totalTricksWonByAll;
-    if (hand.empty() || static_cast<int>(hand.size()) < remainingTricks) {
+    if (hand.empty() || remainingTricks <= 0 || static_cast<int>(hand.size()) < remainingTricks) {
         return false;
     }
-    std::vector<Card> spadesInHand;
-    for (const auto& card : hand) {
-        if (card.suit == Suit::SPADES) {
-            spadesInHand.push_back(card);
+    // The player needs the ace of spades and the remainingTricks - 1 spades below it
+    uint64_t top_spades = (kSuitBits >> (13 - remainingTricks)) << (13 - remainingTricks);
+    return (suitBits(cardBits(hand), kSpades) & top_spades) == top_spades;
+}
+
+// Plays out the rest of the round while every player has exactly one legal card.
+static bool forcedPlayout(const GameState& state, const std::array<uint64_t, 4>& dealt, std::array<int, 4>& tricks) {
+    std::array<uint64_t, 4> hands = dealt;
+    std::array<int, 4> trick_cards{};
+    int trick_size = 0;
+    for (const Card& card : state.currentTrick) {
+        trick_cards[trick_size++] = static_cast<int>(card.suit) * 13 + static_cast<int>(card.rank);
+    }
+    int leader = state.trickLeaderIndex;
+    int player = state.currentPlayerIndex;
+    bool broken = state.spadesBroken;
+    tricks.fill(0);
+
+    while (hands[player] != 0) {
+        uint64_t legal = hands[player];
+        if (trick_size == 0) {
+            if (!broken && (legal & ~kSpadeMask) != 0) legal &= ~kSpadeMask;
+        }
+        else {
+            uint64_t follow = legal & (kSuitBits << (trick_cards[0] / 13 * 13));
+            if (follow != 0) legal = follow;
+        }
+        if ((legal & (legal - 1)) != 0) {
+            return false; // A real choice is left
         }
+        hands[player] &= ~legal;
+        trick_cards[trick_size++] = bitIndex(legal);
+        broken = broken || trick_cards[trick_size - 1] / 13 == kSpades;
+        if (trick_size < 4) {
+            player = (player + 1) % 4;
+            continue;
+        }
+        int best = 0;
+        for (int i = 1; i < 4; ++i) {
+            int suit = trick_cards[i] / 13, best_suit = trick_cards[best] / 13;
+            if ((suit == best_suit && trick_cards[i] > trick_cards[best]) || (suit == kSpades && best_suit != kSpades)) {
+                best = i;
+            }
+        }
+        leader = (leader + best) % 4;
+        tricks[leader]++;
+        player = leader;
+        trick_size = 0;
+    }
+    return true;
+}
+
+bool GameLogic::findClaim(const GameState& state, std::array<int, 4>& tricks) {
+    std::array<uint64_t, 4> hands;
+    int cards_left = 0;
+    for (int p = 0; p < 4; ++p) {
+        hands[p] = cardBits(state.players[p].hand);
+        cards_left += static_cast<int>(state.players[p].hand.size());
     }
-    std::sort(spadesInHand.begin(), spadesInHand.end(), [](const Card& a, const Card& b) {
-        return static_cast<int>(a.rank) > static_cast<int>(b.rank);
-    });
-    if (static_cast<int>(spadesInHand.size()) < remainingTricks) {
+    if (cards_left == 0 || state.bidsMade < 4) {
         return false;
     }
-    for (int i = 0; i < remainingTricks; ++i) {
-        int expectedRank = static_cast<int>(Rank::ACE) - i;
-        if (static_cast<int>(spadesInHand[i].rank) != expectedRank) {
-            return false;
+
+    if (state.currentTrick.empty()) {
+        int leader = state.currentPlayerIndex;
+        int remaining = static_cast<int>(state.players[leader].hand.size());
+
+        // The leader alone: every card is the best left in its suit, and any spades the
+        // others hold can be drawn first
+        uint64_t others = 0;
+        int most_other_spades = 0;
+        for (int p = 0; p < 4; ++p) {
+            if (p == leader) continue;
+            others |= hands[p];
+            most_other_spades = std::max(most_other_spades, bitCount(suitBits(hands[p], kSpades)));
+        }
+        bool all_winners = true;
+        for (int suit = 0; suit < 4 && all_winners; ++suit) {
+            all_winners = outranks(suitBits(hands[leader], suit), suitBits(others, suit));
+        }
+        bool can_draw_spades = most_other_spades == 0 ||
+            (bitCount(suitBits(hands[leader], kSpades)) >= most_other_spades &&
+             (state.spadesBroken || (hands[leader] & ~kSpadeMask) == 0));
+        if (all_winners && can_draw_spades) {
+            tricks.fill(0);
+            tricks[leader] = remaining;
+            return true;
+        }
+
+        // The side on lead: the opponents have no spades and no card that beats one of
+        // the side's in its suit. Who of the two takes each trick is open, so a nil bid
+        // still to be made rules this out.
+        int partner = (leader + 2) % 4;
+        uint64_t side = hands[leader] | hands[partner];
+        uint64_t opponents = hands[(leader + 1) % 4] | hands[(leader + 3) % 4];
+        bool nil_at_risk = false;
+        for (int p : { leader, partner }) {
+            nil_at_risk = nil_at_risk || (state.players[p].bid == 0 && state.players[p].tricksWon == 0);
+        }
+        bool side_winners = !nil_at_risk && suitBits(opponents, kSpades) == 0;
+        for (int suit = 0; suit < 4 && side_winners; ++suit) {
+            side_winners = outranks(suitBits(side, suit), suitBits(opponents, suit));
+        }
+        if (side_winners) {
+            tricks.fill(0);
+            tricks[leader] = remaining;
+            return true;
         }
     }
-    return true;
+
+    return forcedPlayout(state, hands, tricks);
+}
+
+void GameLogic::applyClaim(GameState& state, const std::array<int, 4>& tricks) {
+    for (int p = 0; p < 4; ++p) {
+        state.players[p].tricksWon += tricks[p];
+        state.players[p].hand.clear();
+    }
+    state.currentTrick.clear();
+}
+
+// --- Equivalent Cards ---
+
+std::vector<int> GameLogic::getDistinctMoves(const GameState& state, std::vector<int>* representative) {
+    const auto& hand = state.players[state.currentPlayerIndex].hand;
+    std::vector<int> valid_moves = getValidMoves(state);
+
+    // Cards still able to beat or lose to ours: the other hands and the trick in progress
+    uint64_t live = cardBits(state.currentTrick);
+    for (int p = 0; p < 4; ++p) {
+        if (p != state.currentPlayerIndex) live |= cardBits(state.players[p].hand);
+    }
+    std::array<int, 52> hand_index;
+    hand_index.fill(-1);
+    for (size_t i = 0; i < hand.size(); ++i) {
+        hand_index[static_cast<int>(hand[i].suit) * 13 + static_cast<int>(hand[i].rank)] = static_cast<int>(i);
+    }
+
+    if (representative) {
+        representative->assign(hand.size(), -1);
+    }
+    std::vector<int> distinct_moves;
+    for (int move : valid_moves) {
+        // Walk down the suit to the lowest card of ours not separated by a live card
+        int card = static_cast<int>(hand[move].suit) * 13 + static_cast<int>(hand[move].rank);
+        int lowest = move;
+        for (int below = card - 1; below >= card - card % 13 && !(live >> below & 1); --below) {
+            if (hand_index[below] >= 0) lowest = hand_index[below];
+        }
+        if (lowest == move) {
+            distinct_moves.push_back(move);
+        }
+        if (representative) {
+            (*representative)[move] = lowest;
+        }
+    }
+    return distinct_moves;
 }
 
 void GameLogic::resetForNewRound(GameState& state, int dealerIndex) {
@@ -0,0 +1,403 @@
+#include "include/GameRecord.hpp"
+#include "include/FeatureEncoder.hpp"
+#include "include/GameLogic.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+enum GameRecordTag : uint8_t {
+    kTagRound = 1,
+    kTagBid = 2,
+    kTagPlay = 3,
+    kTagClaim = 4,
+    kTagEnd = 5,
+    kTagFastBid = 6,
+    kTagFastPlay = 7,
+    kTagResign = 8,
+    kTagSplitClaim = 9,
+};
+
+static constexpr char kGameRecordMagic[8] = { 'S', 'P', 'D', 'G', 'A', 'M', 'E', '1' };
+
+// --- Encoding helpers ---
+
+static void putU8(std::string& out, int value) {
+    out.push_back(static_cast<char>(static_cast<uint8_t>(value)));
+}
+
+template <typename T>
+static void putRaw(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T)); // Little-endian hosts only, like the other data formats
+    out.append(bytes, sizeof(T));
+}
+
+static void putVarint(std::string& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// Bounds-checked cursor over one game's bytes.
+class ByteCursor {
+public:
+    explicit ByteCursor(const std::string& bytes) : data(bytes) {}
+
+    bool done() const { return pos >= data.size(); }
+
+    bool u8(int& value) {
+        if (pos + 1 > data.size()) return false;
+        value = static_cast<uint8_t>(data[pos++]);
+        return true;
+    }
+
+    template <typename T>
+    bool raw(T& value) {
+        if (pos + sizeof(T) > data.size()) return false;
+        std::memcpy(&value, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    bool varint(uint32_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            int byte = 0;
+            if (!u8(byte)) return false;
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+private:
+    const std::string& data;
+    size_t pos = 0;
+};
+
+// --- GameRecorder ---
+
+void GameRecorder::beginGame() {
+    buffer.clear();
+}
+
+void GameRecorder::beginRound(int dealer, const GameState& dealt_state) {
+    putU8(buffer, kTagRound);
+    putU8(buffer, dealer);
+    for (const Player& player : dealt_state.players) {
+        putRaw<uint64_t>(buffer, FeatureEncoder::cardMask(player.hand));
+    }
+}
+
+void GameRecorder::recordSearch(const MCTSBot& bot) {
+    const std::vector<int>& visits = bot.getLastVisitCounts();
+    std::vector<float> value = bot.getLastValueEstimate();
+    putRaw<uint16_t>(buffer, static_cast<uint16_t>(bot.getModelGeneration()));
+    putRaw<float>(buffer, value.empty() ? 0.5f : value[0]);
+    putU8(buffer, static_cast<int>(std::count_if(visits.begin(), visits.end(), [](int v) { return v > 0; })));
+    for (size_t action = 0; action < visits.size(); ++action) {
+        if (visits[action] > 0) {
+            putU8(buffer, static_cast<int>(action));
+            putVarint(buffer, static_cast<uint32_t>(visits[action]));
+        }
+    }
+}
+
+void GameRecorder::recordBid(int player, int bid, const MCTSBot& bot, bool fastSearch) {
+    putU8(buffer, fastSearch ? kTagFastBid : kTagBid);
+    putU8(buffer, player);
+    putU8(buffer, bid);
+    recordSearch(bot);
+}
+
+void GameRecorder::recordPlay(int player, const Card& card, const MCTSBot& bot, bool fastSearch) {
+    putU8(buffer, fastSearch ? kTagFastPlay : kTagPlay);
+    putU8(buffer, player);
+    putU8(buffer, FeatureEncoder::cardIndex(card));
+    recordSearch(bot);
+}
+
+void GameRecorder::recordResign(int team) {
+    putU8(buffer, kTagResign);
+    putU8(buffer, team);
+}
+
+void GameRecorder::recordClaim(const std::array<int, 4>& tricks) {
+    int claimants = static_cast<int>(std::count_if(tricks.begin(), tricks.end(), [](int t) { return t > 0; }));
+    if (claimants == 1) {
+        int player = static_cast<int>(std::find_if(tricks.begin(), tricks.end(), [](int t) { return t > 0; }) - tricks.begin());
+        putU8(buffer, kTagClaim);
+        putU8(buffer, player);
+        putU8(buffer, tricks[player]);
+        return;
+    }
+    putU8(buffer, kTagSplitClaim);
+    for (int t : tricks) {
+        putU8(buffer, t);
+    }
+}
+
+void GameRecorder::endGame(int winning_team_id) {
+    putU8(buffer, kTagEnd);
+    putU8(buffer, winning_team_id);
+}
+
+// --- GameRecordWriter / GameRecordReader ---
+
+GameRecordWriter::GameRecordWriter(const std::string& path) : path(path) {
+    std::error_code ec;
+    bool append = std::filesystem::exists(path, ec) && std::filesystem::file_size(path, ec) > 0;
+    if (append) {
+        // Keep only the whole games: one cut short by a crash would misframe every game
+        // appended after it
+        uint64_t complete_bytes = sizeof(kGameRecordMagic);
+        {
+            GameRecordReader reader(path); // Throws if this is not a game record file
+            std::string game;
+            while (reader.next(game)) {
+                complete_bytes += sizeof(uint32_t) + game.size();
+            }
+        }
+        std::filesystem::resize_file(path, complete_bytes);
+    }
+    file = std::fopen(path.c_str(), append ? "ab" : "wb");
+    if (!file) {
+        throw std::runtime_error("Could not open game record file for writing: " + path);
+    }
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+    if (!append && std::fwrite(kGameRecordMagic, 1, sizeof(kGameRecordMagic), file) != sizeof(kGameRecordMagic)) {
+        std::fclose(file);
+        throw std::runtime_error("Failed to write header of " + path);
+    }
+}
+
+GameRecordWriter::~GameRecordWriter() {
+    try {
+        close();
+    }
+    catch (const std::exception&) {
+        // Nothing sensible to do from a destructor; close() reports errors to explicit callers.
+    }
+}
+
+void GameRecordWriter::writeGame(const std::string& game) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file) {
+        throw std::runtime_error("GameRecordWriter::writeGame called after close.");
+    }
+    uint32_t length = static_cast<uint32_t>(game.size());
+    if (std::fwrite(&length, sizeof(length), 1, file) != 1 || std::fwrite(game.data(), 1, game.size(), file) != game.size()) {
+        throw std::runtime_error("Failed to write game record to " + path);
+    }
+    game_count++;
+}
+
+void GameRecordWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file) return;
+    bool ok = std::fflush(file) == 0;
+    std::fclose(file);
+    file = nullptr;
+    if (!ok) {
+        throw std::runtime_error("Failed to flush game records to " + path);
+    }
+}
+
+GameRecordReader::GameRecordReader(const std::string& path) {
+    file = std::fopen(path.c_str(), "rb");
+    char magic[sizeof(kGameRecordMagic)];
+    if (!file || std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+        std::memcmp(magic, kGameRecordMagic, sizeof(magic)) != 0) {
+        if (file) std::fclose(file);
+        throw std::runtime_error("Not a game record file: " + path);
+    }
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+}
+
+GameRecordReader::~GameRecordReader() {
+    std::fclose(file);
+}
+
+bool GameRecordReader::next(std::string& game) {
+    uint32_t length = 0;
+    if (std::fread(&length, sizeof(length), 1, file) != 1) {
+        return false;
+    }
+    game.resize(length);
+    return std::fread(&game[0], 1, length, file) == length;
+}
+
+// --- GameReplay ---
+
+// Rebuilds the policy the search reported: visit shares, or its uniform fallback
+// over the legal actions when nothing was visited (see MCTSBot::runMCTS).
+static bool readPolicy(ByteCursor& in, const GameState& state, bool isBidding, std::vector<float>& policy,
+                       int& visit_total, float& value, int& generation) {
+    uint16_t gen = 0;
+    int entries = 0;
+    if (!in.raw(gen) || !in.raw(value) || !in.u8(entries)) return false;
+    generation = gen;
+
+    policy.assign(isBidding ? 14 : state.players[state.currentPlayerIndex].hand.size(), 0.0f);
+    float total = 0.0f;
+    visit_total = 0;
+    for (int i = 0; i < entries; ++i) {
+        int action = 0;
+        uint32_t visits = 0;
+        if (!in.u8(action) || !in.varint(visits) || action >= static_cast<int>(policy.size())) return false;
+        policy[action] += static_cast<float>(visits);
+        total += static_cast<float>(visits);
+        visit_total += static_cast<int>(visits);
+    }
+    if (total > 0) {
+        for (float& p : policy) {
+            p /= total;
+        }
+    }
+    else if (isBidding) {
+        std::fill(policy.begin(), policy.end(), 1.0f / 14.0f);
+    }
+    else {
+        std::vector<int> valid = GameLogic::getValidMoves(state);
+        for (int move : valid) {
+            policy[move] = 1.0f / static_cast<float>(valid.size());
+        }
+    }
+    return true;
+}
+
+static bool replayEvents(const std::string& game, DataCollector& collector, std::string& error) {
+    ByteCursor in(game);
+    GameState state;
+    std::vector<float> policy;
+    bool round_open = false;
+    int resigned_team = -1;
+
+    auto closeRound = [&]() {
+        if (round_open) {
+            int team1RoundPoints, team2RoundPoints;
+            GameLogic::updateScores(state, team1RoundPoints, team2RoundPoints);
+            round_open = false;
+        }
+    };
+
+    while (!in.done()) {
+        int tag = 0, player = 0, action = 0;
+        if (!in.u8(tag)) break;
+        switch (tag) {
+        case kTagRound: {
+            closeRound();
+            int dealer = 0;
+            uint64_t masks[4];
+            if (!in.u8(dealer) || dealer > 3) { error = "bad round header"; return false; }
+            for (uint64_t& mask : masks) {
+                if (!in.raw(mask)) { error = "truncated deal"; return false; }
+            }
+            GameLogic::resetForNewRound(state, dealer);
+            // Lay the deck out so dealCards hands card i to player i % 4
+            std::vector<Card> hands[4];
+            for (int p = 0; p < 4; ++p) {
+                for (int idx = 0; idx < 52; ++idx) {
+                    if ((masks[p] >> idx) & 1) {
+                        hands[p].push_back({ static_cast<Suit>(idx / 13), static_cast<Rank>(idx % 13) });
+                    }
+                }
+                if (hands[p].size() != 13) { error = "deal is not 4 x 13 cards"; return false; }
+            }
+            for (int i = 0; i < 52; ++i) {
+                state.deck.push_back(hands[i % 4][i / 4]);
+            }
+            GameLogic::dealCards(state);
+            round_open = true;
+            break;
+        }
+        case kTagBid:
+        case kTagPlay:
+        case kTagFastBid:
+        case kTagFastPlay: {
+            bool isBidding = tag == kTagBid || tag == kTagFastBid;
+            bool fastSearch = tag == kTagFastBid || tag == kTagFastPlay;
+            int visit_total = 0, generation = 0;
+            float value = 0.0f;
+            if (!in.u8(player) || !in.u8(action)) { error = "truncated decision"; return false; }
+            if (!round_open || player != state.currentPlayerIndex) { error = "decision out of turn"; return false; }
+            if (!readPolicy(in, state, isBidding, policy, visit_total, value, generation)) { error = "bad search result"; return false; }
+
+            collector.recordDecision(state, isBidding, policy, visit_total, value, generation, fastSearch);
+            if (isBidding) {
+                if (action > 13) { error = "bid out of range"; return false; }
+                state.players[player].bid = action;
+                GameLogic::applyBid(state, action);
+            }
+            else {
+                const auto& hand = state.players[player].hand;
+                auto it = std::find_if(hand.begin(), hand.end(), [action](const Card& c) { return FeatureEncoder::cardIndex(c) == action; });
+                int move = static_cast<int>(it - hand.begin());
+                std::vector<int> valid = GameLogic::getValidMoves(state);
+                if (it == hand.end() || std::find(valid.begin(), valid.end(), move) == valid.end()) {
+                    error = "illegal card played";
+                    return false;
+                }
+                GameLogic::applyMove(state, move);
+            }
+            break;
+        }
+        case kTagClaim: {
+            int tricks = 0;
+            if (!in.u8(player) || !in.u8(tricks) || player > 3 || !round_open) { error = "bad claim"; return false; }
+            state.players[player].tricksWon += tricks;
+            closeRound();
+            break;
+        }
+        case kTagSplitClaim: {
+            if (!round_open) { error = "bad claim"; return false; }
+            for (auto& claimant : state.players) {
+                int tricks = 0;
+                if (!in.u8(tricks)) { error = "truncated claim"; return false; }
+                claimant.tricksWon += tricks;
+            }
+            closeRound();
+            break;
+        }
+        case kTagResign: {
+            if (!in.u8(resigned_team) || resigned_team > 1) { error = "bad resignation"; return false; }
+            round_open = false; // The unfinished round is not scored
+            break;
+        }
+        case kTagEnd: {
+            int winning_team_id = 0;
+            if (!in.u8(winning_team_id)) { error = "truncated game end"; return false; }
+            if (resigned_team >= 0) {
+                if (winning_team_id != 1 - resigned_team) { error = "resigned game won by the resigning team"; return false; }
+                collector.finalize(winning_team_id);
+                return true;
+            }
+            closeRound();
+            // Same rule as self-play (ties count for team 1); a mismatch means the rules changed.
+            int replayed_winner = state.team2Score > state.team1Score ? 1 : 0;
+            if (!GameLogic::isGameOver(state) || replayed_winner != winning_team_id) {
+                error = "replayed result differs from the recorded one";
+                return false;
+            }
+            collector.finalize(winning_team_id);
+            return true;
+        }
+        default:
+            error = "unknown event " + std::to_string(tag);
+            return false;
+        }
+    }
+    error = "game has no end event";
+    return false;
+}
+
+bool GameReplay::replay(const std::string& game, DataCollector& collector, std::string& error) {
+    if (replayEvents(game, collector, error)) {
+        return true;
+    }
+    collector.discard();
+    return false;
+}
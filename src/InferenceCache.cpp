@@ -0,0 +1,127 @@
+#include "include/InferenceCache.hpp"
+#include <algorithm>
+#include <cstring>
+
+InferenceCache::InferenceCache(size_t max_bytes, size_t shard_count)
+    : shard_max_bytes(max_bytes / std::max<size_t>(shard_count, 1)) {
+    shards.reserve(std::max<size_t>(shard_count, 1));
+    for (size_t i = 0; i < std::max<size_t>(shard_count, 1); ++i) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+}
+
+// Word-at-a-time multiply/xor-shift mix over the raw float bytes; feature vectors
+// are a few hundred bytes, so this costs far less than a single Session::Run.
+uint64_t InferenceCache::hashInput(const std::vector<float>& input, const std::vector<int64_t>& shape) {
+    const uint64_t k = 0x9E3779B97F4A7C15ull;
+    uint64_t h = 0xCBF29CE484222325ull ^ (input.size() * k);
+    auto mix = [&h, k](uint64_t word) {
+        h = (h ^ word) * k;
+        h ^= h >> 29;
+    };
+    for (int64_t dim : shape) {
+        mix(static_cast<uint64_t>(dim));
+    }
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(input.data());
+    size_t byte_count = input.size() * sizeof(float);
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= byte_count; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        mix(word);
+    }
+    if (i < byte_count) {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes + i, byte_count - i);
+        mix(word);
+    }
+    return h ^ (h >> 32);
+}
+
+size_t InferenceCache::entryBytes(const Entry& entry) {
+    size_t bytes = sizeof(Entry) + entry.input.size() * sizeof(float) + entry.shape.size() * sizeof(int64_t);
+    for (const auto& output : entry.outputs) {
+        bytes += sizeof(output) + output.size() * sizeof(float);
+    }
+    return bytes + 4 * sizeof(void*); // List node and index bucket overhead
+}
+
+bool InferenceCache::lookup(const std::vector<float>& input, const std::vector<int64_t>& shape,
+                            std::vector<std::vector<float>>& outputs) {
+    uint64_t hash = hashInput(input, shape);
+    Shard& shard = shardFor(hash);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto range = shard.index.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            Entry& entry = *it->second;
+            if (entry.shape == shape && entry.input == input) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                outputs = entry.outputs;
+                hits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void InferenceCache::insert(const std::vector<float>& input, const std::vector<int64_t>& shape,
+                            const std::vector<std::vector<float>>& outputs) {
+    uint64_t hash = hashInput(input, shape);
+    Entry entry{ hash, input, shape, outputs, 0 };
+    entry.bytes = entryBytes(entry);
+    if (entry.bytes > shard_max_bytes) {
+        return;
+    }
+
+    Shard& shard = shardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto range = shard.index.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->shape == shape && it->second->input == input) {
+            return; // Another search computed the same position first
+        }
+    }
+
+    while (!shard.lru.empty() && shard.bytes + entry.bytes > shard_max_bytes) {
+        auto victim = std::prev(shard.lru.end());
+        auto victims = shard.index.equal_range(victim->hash);
+        for (auto it = victims.first; it != victims.second; ++it) {
+            if (it->second == victim) {
+                shard.index.erase(it);
+                break;
+            }
+        }
+        shard.bytes -= victim->bytes;
+        shard.lru.erase(victim);
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    shard.bytes += entry.bytes;
+    shard.lru.push_front(std::move(entry));
+    shard.index.emplace(hash, shard.lru.begin());
+}
+
+InferenceCacheStats InferenceCache::stats() const {
+    InferenceCacheStats result;
+    result.hits = hits.load(std::memory_order_relaxed);
+    result.misses = misses.load(std::memory_order_relaxed);
+    result.evictions = evictions.load(std::memory_order_relaxed);
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        result.entries += shard->lru.size();
+        result.bytes += shard->bytes;
+    }
+    return result;
+}
+
+void InferenceCache::clear() {
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->lru.clear();
+        shard->index.clear();
+        shard->bytes = 0;
+    }
+}
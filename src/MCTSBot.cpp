@@ -1,8 +1,11 @@
 #include "include/MCTSBot.hpp"
 #include "include/GameLogic.hpp"
+#include "include/SuitIsomorphism.hpp"
+#include "include/FeatureEncoder.hpp"
 #include <cmath>
 #include <numeric>
 #include <algorithm>
+#include <climits>
 #include <iostream>
 #include <stdexcept>
 #include <map>
@@ -29,8 +32,8 @@ public:
             return children.size() == 14;
         }
         else {
-            // For playing, we expand all valid moves in the current state
-            return children.size() == GameLogic::getValidMoves(current_state).size();
+            // For playing, we expand one card of each class of equivalent valid moves
+            return children.size() == GameLogic::getDistinctMoves(current_state).size();
         }
     }
 
@@ -69,6 +72,64 @@ public:
 };
 
 
+// --- Exact Endgame Solving ---
+// Like the search itself, the solver sees the full deal. The objective is the round
+// score margin, so bids, nils and bags are played for, not just tricks.
+
+// Round points of `team` minus those of the other team, once the round is over
+static int roundMargin(const GameState& state, int team) {
+    GameState scored = state;
+    int team1RoundPoints = 0, team2RoundPoints = 0;
+    GameLogic::updateScores(scored, team1RoundPoints, team2RoundPoints);
+    return team == 0 ? team1RoundPoints - team2RoundPoints : team2RoundPoints - team1RoundPoints;
+}
+
+// Alpha-beta over the rest of the card play; `team` maximizes the margin.
+static int solveMargin(const GameState& state, int team, int alpha, int beta) {
+    if (GameLogic::isRoundOver(state)) {
+        return roundMargin(state, team);
+    }
+    std::array<int, 4> claimed;
+    if (GameLogic::findClaim(state, claimed)) {
+        GameState settled = state;
+        GameLogic::applyClaim(settled, claimed);
+        return roundMargin(settled, team);
+    }
+    bool maximizing = state.currentPlayerIndex % 2 == team;
+    int best = maximizing ? INT_MIN : INT_MAX;
+    for (int move : GameLogic::getDistinctMoves(state)) {
+        GameState child = state;
+        GameLogic::applyMove(child, move);
+        int margin = solveMargin(child, team, alpha, beta);
+        if (maximizing) {
+            best = std::max(best, margin);
+            alpha = std::max(alpha, best);
+        }
+        else {
+            best = std::min(best, margin);
+            beta = std::min(beta, best);
+        }
+        if (alpha >= beta) break;
+    }
+    return best;
+}
+
+// Exact margin after each distinct move of the player to move, and the best of them for that player
+static int solveMoves(const GameState& state, int team, std::vector<int>& moves, std::vector<int>& margins) {
+    moves = GameLogic::getDistinctMoves(state);
+    margins.assign(moves.size(), 0);
+    bool maximizing = state.currentPlayerIndex % 2 == team;
+    int best = maximizing ? INT_MIN : INT_MAX;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        GameState child = state;
+        GameLogic::applyMove(child, moves[i]);
+        margins[i] = solveMargin(child, team, INT_MIN, INT_MAX);
+        best = maximizing ? std::max(best, margins[i]) : std::min(best, margins[i]);
+    }
+    return best;
+}
+
+
 // --- MCTSBot Implementation ---
 
 MCTSBot::MCTSBot(int simulations_per_move,
@@ -81,124 +142,238 @@ MCTSBot::MCTSBot(int simulations_per_move,
     rng.seed(rd());
 }
 
-// Helper to convert game state to a feature vector for NN3
-std::vector<float> stateToNN3Features(const GameState& state, int perspective_player_idx) {
-    int perspective_team_id = perspective_player_idx % 2; // 0 for team 1, 1 for team 2
-    float team_score = (perspective_team_id == 0) ? static_cast<float>(state.team1Score) : static_cast<float>(state.team2Score);
-    float other_team_score = (perspective_team_id == 1) ? static_cast<float>(state.team1Score) : static_cast<float>(state.team2Score);
-    float team_bags = (perspective_team_id == 0) ? static_cast<float>(state.team1Bags) : static_cast<float>(state.team2Bags);
-    float other_team_bags = (perspective_team_id == 1) ? static_cast<float>(state.team1Bags) : static_cast<float>(state.team2Bags);
-
-    return { team_score + other_team_score, team_score - other_team_score, team_bags, other_team_bags };
+MCTSBot::MCTSBot(int simulations_per_move,
+    std::shared_ptr<ONNXModel> nn1,
+    std::shared_ptr<PolicyValueModel> pv,
+    std::shared_ptr<ONNXModel> nn3)
+    : simulationsPerMove(simulations_per_move),
+    nn1_model(nn1), nn3_model(nn3), pv_model(pv) {
+    std::random_device rd;
+    rng.seed(rd());
 }
 
-// Helper to convert game state to feature vector for NN1 (Bidding)
-std::vector<float> stateToNN1Features(const GameState& state) {
-    std::vector<float> features;
-    features.push_back(static_cast<float>(state.team1Score));
-    features.push_back(static_cast<float>(state.team2Score));
-    features.push_back(static_cast<float>(state.team1Bags));
-    features.push_back(static_cast<float>(state.team2Bags));
-    for (int i = 0; i < 4; ++i) {
-        features.push_back(static_cast<float>((i < state.bidsMade) ? state.players[i].bid : -1.0f));
-    }
-    return features;
+void MCTSBot::updateModels(const ModelSet& models) {
+    nn1_model = models.nn1;
+    nn2_model = models.pv ? nullptr : models.nn2;
+    nn3_model = models.nn3;
+    pv_model = models.pv;
+    modelGeneration = models.generation;
 }
 
-// Helper to convert game state to feature vector for NN2 (Playing)
-std::vector<float> stateToNN2Features(const GameState& state) {
-    std::vector<float> features;
-    // Add team scores and bags
-    features.push_back(static_cast<float>(state.team1Score));
-    features.push_back(static_cast<float>(state.team2Score));
-    features.push_back(static_cast<float>(state.team1Bags));
-    features.push_back(static_cast<float>(state.team2Bags));
-
-    // Add all player bids
-    for (int i = 0; i < 4; ++i) {
-        features.push_back(static_cast<float>(state.players[i].bid));
+void MCTSBot::setDoubleDummyRollouts(int tricks) {
+    ddRolloutTricks = tricks;
+    if (tricks > 0 && !ddSolver) {
+        // Rollout endings are small: a modest table holds most of what is worth keeping
+        ddSolver = std::make_unique<DoubleDummySolver>(size_t{1} << 16);
     }
+}
 
-    // Add cards in hand (52-bit multi-hot encoding)
-    std::vector<bool> hand_encoding(52, false);
-    for (const auto& card : state.players[state.currentPlayerIndex].hand) {
-        hand_encoding[static_cast<int>(card.suit) * 13 + static_cast<int>(card.rank)] = true;
+// Restrict a raw playing policy to the valid moves of `state` and renormalize,
+// falling back to uniform over valid moves if the network gives them no mass.
+std::vector<float> maskPolicyToValidMoves(const std::vector<float>& raw_policy, const GameState& state) {
+    std::vector<int> valid_moves = GameLogic::getValidMoves(state);
+    std::vector<float> priors(raw_policy.size(), 0.0f); // Initialize to zeros
+
+    float sum_valid_probs = 0.0f; // Use float for sum
+    for (int move_idx : valid_moves) {
+        if (move_idx < raw_policy.size()) {
+            priors[move_idx] = raw_policy[move_idx];
+            sum_valid_probs += raw_policy[move_idx];
+        }
+    }
+    // Normalize only valid moves
+    if (sum_valid_probs > 0) {
+        for (int move_idx : valid_moves) {
+            if (move_idx < priors.size()) {
+                priors[move_idx] /= sum_valid_probs;
+            }
+        }
     }
-    for (bool bit : hand_encoding) {
-        features.push_back(static_cast<float>(bit));
+    else { // Fallback to uniform if NN gives all zeros for valid moves
+        for (int move_idx : valid_moves) {
+            if (move_idx < priors.size()) {
+                priors[move_idx] = 1.0f / valid_moves.size();
+            }
+        }
     }
+    // Equivalent cards pool their prior on the one card the search expands for them
+    std::vector<int> representative;
+    GameLogic::getDistinctMoves(state, &representative);
+    for (int move_idx : valid_moves) {
+        int rep = representative[move_idx];
+        if (rep != move_idx && static_cast<size_t>(move_idx) < priors.size() && static_cast<size_t>(rep) < priors.size()) {
+            priors[rep] += priors[move_idx];
+            priors[move_idx] = 0.0f;
+        }
+    }
+    return priors;
+}
 
-    // Add cards in current trick (52-bit multi-hot encoding)
-    std::vector<bool> trick_encoding(52, false);
-    for (const auto& card : state.currentTrick) {
-        trick_encoding[static_cast<int>(card.suit) * 13 + static_cast<int>(card.rank)] = true;
+// Shares the visits of each expanded card out among the equivalent cards it stood for,
+// as evenly as whole visits allow, so the policy does not depend on which was expanded.
+static void shareEquivalentVisits(const GameState& state, std::vector<int>& visits) {
+    std::vector<int> representative;
+    GameLogic::getDistinctMoves(state, &representative);
+    std::vector<int> class_size(visits.size(), 0);
+    for (int rep : representative) {
+        if (rep >= 0) class_size[rep]++;
     }
-    for (bool bit : trick_encoding) {
-        features.push_back(static_cast<float>(bit));
+    std::vector<int> shared(visits.size(), 0);
+    std::vector<int> handed_out(visits.size(), 0);
+    for (size_t i = 0; i < representative.size() && i < visits.size(); ++i) {
+        int rep = representative[i];
+        if (rep < 0) continue;
+        shared[i] = visits[rep] / class_size[rep] + (handed_out[rep] < visits[rep] % class_size[rep] ? 1 : 0);
+        handed_out[rep]++;
     }
+    visits = shared;
+}
+
 
-    // Add trick history (e.g., last 3 tricks played - more complex, placeholder for now)
-    // For simplicity, we'll just add the current number of tricks won by each player
-    for (int i = 0; i < 4; ++i) {
-        features.push_back(static_cast<float>(state.players[i].tricksWon));
+// Runs the playing network (fused when available, otherwise NN2) on `state`. The raw
+// policy is returned unmasked; value is only meaningful with the fused model.
+PolicyValueOutput MCTSBot::evaluatePlaying(const GameState& state) {
+    FeatureEncoder::encodePlay(state, play_row);
+    SuitPermutation perm;
+    if (canonicalizeSuits) {
+        perm = SuitIsomorphism::canonicalFeaturePermutation(play_row);
+        SuitIsomorphism::permuteFeatures(play_row, perm);
     }
 
-    // Indicate if spades are broken
-    features.push_back(static_cast<float>(state.spadesBroken ? 1.0f : 0.0f));
+    PolicyValueOutput result;
+    if (pv_model) {
+        result = pv_model->evaluate(play_row);
+    }
+    else {
+        std::vector<int64_t> shape = { 1, static_cast<int64_t>(FeatureEncoder::kPlayFeatureCount) };
+        result.policy = nn2_model->predict(play_row, shape);
+    }
 
-    // Current player index
-    features.push_back(static_cast<float>(state.currentPlayerIndex));
+    if (canonicalizeSuits) {
+        result.policy = SuitIsomorphism::policyToOriginal(result.policy, state.players[state.currentPlayerIndex].hand, perm);
+    }
+    return result;
+}
 
-    return features;
+// Bank simulations a decision did not need, up to the cap.
+void MCTSBot::bankSimulations(int unused) {
+    int cap = static_cast<int>(budgetOptions.max_carry * simulationsPerMove);
+    carriedSimulations = std::min(cap, carriedSimulations + std::max(0, unused));
 }
 
+// Budget of a search with `branching` options at a point of the round weighted by `phase`.
+// Decisions below the nominal budget bank the difference; those above draw on the bank.
+int MCTSBot::scheduleSimulations(double branching, double phase) {
+    int nominal = simulationsPerMove;
+    if (!budgetOptions.enabled) {
+        return nominal;
+    }
+    double scale = std::min(budgetOptions.max_scale, std::sqrt(branching / budgetOptions.reference_branching) * phase);
+    int wanted = std::max(static_cast<int>(std::lround(nominal * scale)), std::min(budgetOptions.min_simulations, nominal));
+    if (wanted <= nominal) {
+        bankSimulations(nominal - wanted);
+        return wanted;
+    }
+    int extra = std::min(wanted - nominal, carriedSimulations);
+    carriedSimulations -= extra;
+    return nominal + extra;
+}
+
+// Solves the rest of the card play. The policy is uniform over the optimal moves, and
+// the value is NN3's view of the position at the end of one optimal line.
+void MCTSBot::solveEndgame(const GameState& state) {
+    int team = state.currentPlayerIndex % 2;
+    std::vector<int> moves, margins;
+    int best = solveMoves(state, team, moves, margins);
+
+    size_t hand_size = state.players[state.currentPlayerIndex].hand.size();
+    lastActionProbs.assign(hand_size, 0.0f);
+    lastVisitCounts.assign(hand_size, 0);
+    std::vector<int> representative;
+    GameLogic::getDistinctMoves(state, &representative);
+    int optimal = 0;
+    for (size_t i = 0; i < hand_size; ++i) {
+        int rep = representative[i];
+        if (rep >= 0 && margins[std::find(moves.begin(), moves.end(), rep) - moves.begin()] == best) {
+            lastVisitCounts[i] = 1; // Equivalent cards are all optimal together
+            optimal++;
+        }
+    }
+    for (size_t i = 0; i < hand_size; ++i) {
+        lastActionProbs[i] = static_cast<float>(lastVisitCounts[i]) / optimal;
+    }
+
+    // Follow an optimal line to the end of the round
+    GameState line = state;
+    while (!GameLogic::isRoundOver(line)) {
+        int line_best = solveMoves(line, team, moves, margins);
+        size_t pick = std::find(margins.begin(), margins.end(), line_best) - margins.begin();
+        GameLogic::applyMove(line, moves[pick]);
+    }
+    int team1RoundPoints, team2RoundPoints;
+    GameLogic::updateScores(line, team1RoundPoints, team2RoundPoints);
+    float value = best > 0 ? 1.0f : (best < 0 ? 0.0f : 0.5f); // Without NN3, only the round is known
+    if (nn3_model) {
+        FeatureEncoder::encodeValue(line, team, value_row);
+        std::vector<int64_t> nn3_shape = { 1, static_cast<int64_t>(FeatureEncoder::kValueFeatureCount) };
+        auto result_vec = nn3_model->predict(value_row, nn3_shape);
+        if (!result_vec.empty()) {
+            value = result_vec[0];
+        }
+    }
+    lastValueEstimate = { value };
+}
 
 std::unique_ptr<MCTSNode> MCTSBot::runMCTS(const GameState& rootState, bool isBidding) {
     auto root = std::make_unique<MCTSNode>(rootState, nullptr, -1, isBidding);
 
     // Get policy priors from NN1/NN2 if models are available
     if (isBidding && nn1_model) {
-        std::vector<float> nn1_features = stateToNN1Features(rootState);
-        std::vector<int64_t> nn1_shape = { 1, static_cast<int64_t>(nn1_features.size()) };
-        root->prior_probabilities = nn1_model->predict(nn1_features, nn1_shape);
+        FeatureEncoder::encodeBid(rootState, bid_row);
+        std::vector<int64_t> nn1_shape = { 1, static_cast<int64_t>(FeatureEncoder::kBidFeatureCount) };
+        root->prior_probabilities = nn1_model->predict(bid_row, nn1_shape);
+    }
+    else if (!isBidding && (pv_model || nn2_model)) {
+        // Ensure the policy output is masked for valid moves
+        root->prior_probabilities = maskPolicyToValidMoves(evaluatePlaying(rootState).policy, rootState);
     }
-    else if (!isBidding && nn2_model) {
-        std::vector<float> nn2_features = stateToNN2Features(rootState);
-        std::vector<int64_t> nn2_shape = { 1, static_cast<int64_t>(nn2_features.size()) };
-        // Ensure NN2 output is masked for valid moves
-        std::vector<float> raw_nn2_output = nn2_model->predict(nn2_features, nn2_shape);
-
-        std::vector<int> valid_moves = GameLogic::getValidMoves(rootState);
-        root->prior_probabilities.assign(raw_nn2_output.size(), 0.0f); // Initialize to zeros
 
-        float sum_valid_probs = 0.0f; // Use float for sum
-        for (int move_idx : valid_moves) {
-            if (move_idx < raw_nn2_output.size()) {
-                root->prior_probabilities[move_idx] = raw_nn2_output[move_idx];
-                sum_valid_probs += raw_nn2_output[move_idx];
-            }
-        }
-        // Normalize only valid moves
-        if (sum_valid_probs > 0) {
-            for (int move_idx : valid_moves) {
-                if (move_idx < root->prior_probabilities.size()) {
-                    root->prior_probabilities[move_idx] /= sum_valid_probs;
-                }
-            }
-        }
-        else { // Fallback to uniform if NN gives all zeros for valid moves
-            for (int move_idx : valid_moves) {
-                if (move_idx < root->prior_probabilities.size()) {
-                    root->prior_probabilities[move_idx] = 1.0f / valid_moves.size();
-                }
-            }
+    // Bids are weighed by the effective number of options NN1 leaves open (the perplexity
+    // of its prior); card plays by their legal moves and by how much of the round is left.
+    double branching = 14.0;
+    double phase = 1.0;
+    if (isBidding && !root->prior_probabilities.empty()) {
+        double total = std::accumulate(root->prior_probabilities.begin(), root->prior_probabilities.end(), 0.0);
+        double entropy = 0.0;
+        for (float p : root->prior_probabilities) {
+            if (p > 0.0f && total > 0.0) entropy -= (p / total) * std::log(p / total);
         }
+        branching = std::exp(entropy);
+    }
+    else if (!isBidding) {
+        branching = static_cast<double>(GameLogic::getDistinctMoves(rootState).size());
+        phase = 0.75 + 0.5 * rootState.players[rootState.currentPlayerIndex].hand.size() / 13.0;
     }
+    int simulations = scheduleSimulations(branching, phase);
+    if (isBidding && root->prior_probabilities.empty()) {
+        // Without NN1, bids are expanded from 0 up: fewer than 14 simulations (a fast
+        // search, say) could never reach the high ones
+        simulations = std::max(simulations, 14);
+    }
+    lastSearchKind = SearchKind::Searched;
+    lastSimulations = simulations;
+
+    int perspective_team_id = rootState.currentPlayerIndex % 2; // Values are backed up from the root player's team
+    // Use RandomBot for fast rollouts for now. One per search: constructing it seeds
+    // from std::random_device, which is too costly (and contended) per simulation.
+    RandomBot rollout_bot;
 
 
-    for (int i = 0; i < simulationsPerMove; ++i) {
+    for (int i = 0; i < simulations; ++i) {
         MCTSNode* current_node = root.get();
         GameState sim_state = rootState; // Copy for simulation, MCTSNode stores its own state
+        bool leaf_evaluated = false; // Set when the fused model already valued the new leaf
+        double value = 0.5; // Default if NN3 not available
 
         // 1. SELECTION
         while (!GameLogic::isRoundOver(sim_state) && current_node->is_fully_expanded(sim_state)) {
@@ -220,6 +395,12 @@ std::unique_ptr<MCTSNode> MCTSBot::runMCTS(const GameState& rootState, bool isBi
         if (!GameLogic::isRoundOver(sim_state) && !current_node->is_fully_expanded(sim_state)) {
             std::vector<int> available_moves_for_expansion; // The actual moves (bids or hand indices)
             if (current_node->is_bidding_node) {
+                // Bids are expanded in order of NN1's prior, most likely first, so a budget
+                // too small for all 14 leaves out the unlikely bids rather than the high ones.
+                // Without a prior they go from 0 up.
+                const auto& bid_priors = current_node->prior_probabilities;
+                auto prior_of = [&](int bid) { return bid < static_cast<int>(bid_priors.size()) ? bid_priors[bid] : 0.0f; };
+                int next_bid = -1;
                 for (int bid_val = 0; bid_val <= 13; ++bid_val) {
                     // Check if this bid has already been expanded
                     bool expanded = false;
@@ -229,14 +410,16 @@ std::unique_ptr<MCTSNode> MCTSBot::runMCTS(const GameState& rootState, bool isBi
                             break;
                         }
                     }
-                    if (!expanded) {
-                        available_moves_for_expansion.push_back(bid_val);
-                        break; // Expand only one new node per iteration
+                    if (!expanded && (next_bid < 0 || prior_of(bid_val) > prior_of(next_bid))) {
+                        next_bid = bid_val;
                     }
                 }
+                if (next_bid >= 0) {
+                    available_moves_for_expansion.push_back(next_bid); // Expand only one new node per iteration
+                }
             }
             else { // Playing card
-                std::vector<int> valid_moves = GameLogic::getValidMoves(sim_state);
+                std::vector<int> valid_moves = GameLogic::getDistinctMoves(sim_state);
                 for (int move_idx : valid_moves) {
                     bool expanded = false;
                     for (const auto& child : current_node->children) {
@@ -265,14 +448,21 @@ std::unique_ptr<MCTSNode> MCTSBot::runMCTS(const GameState& rootState, bool isBi
                 // Get policy priors for the *new* child node
                 std::vector<float> child_priors;
                 if (isBidding && nn1_model) {
-                    std::vector<float> child_nn1_features = stateToNN1Features(next_state_for_child);
-                    std::vector<int64_t> child_nn1_shape = { 1, static_cast<int64_t>(child_nn1_features.size()) };
-                    child_priors = nn1_model->predict(child_nn1_features, child_nn1_shape);
+                    FeatureEncoder::encodeBid(next_state_for_child, bid_row);
+                    std::vector<int64_t> child_nn1_shape = { 1, static_cast<int64_t>(FeatureEncoder::kBidFeatureCount) };
+                    child_priors = nn1_model->predict(bid_row, child_nn1_shape);
+                }
+                else if (!isBidding && pv_model && !GameLogic::isRoundOver(next_state_for_child)) {
+                    // One feature build and one inference give both the child's priors and its value.
+                    PolicyValueOutput child_eval = evaluatePlaying(next_state_for_child);
+                    child_priors = maskPolicyToValidMoves(child_eval.policy, next_state_for_child);
+                    // The value head predicts for the team to move; back up from the root team's view.
+                    bool same_team = (next_state_for_child.currentPlayerIndex % 2) == perspective_team_id;
+                    value = same_team ? child_eval.value : 1.0 - child_eval.value;
+                    leaf_evaluated = true;
                 }
                 else if (!isBidding && nn2_model) {
-                    std::vector<float> child_nn2_features = stateToNN2Features(next_state_for_child);
-                    std::vector<int64_t> child_nn2_shape = { 1, static_cast<int64_t>(child_nn2_features.size()) };
-                    child_priors = nn2_model->predict(child_nn2_features, child_nn2_shape);
+                    child_priors = evaluatePlaying(next_state_for_child).policy;
                     // Mask and normalize child_priors for valid moves here if needed
                 }
 
@@ -285,42 +475,63 @@ std::unique_ptr<MCTSNode> MCTSBot::runMCTS(const GameState& rootState, bool isBi
         // Ensure sim_state is reset to the state of the node we are rolling out from.
         // This is crucial. If we expanded, sim_state is already at the expanded node's state.
         // If no expansion, sim_state is at the selected node's state.
-        RandomBot rollout_bot; // Use RandomBot for fast rollouts for now
-        int current_rollout_player_idx = sim_state.currentPlayerIndex; // Track who's turn it is in the rollout
-
-        while (!GameLogic::isGameOver(sim_state) && !GameLogic::isRoundOver(sim_state)) {
-            if (sim_state.bidsMade < 4) { // Bidding phase during rollout
-                int bid = rollout_bot.getBid(sim_state.players[current_rollout_player_idx], sim_state);
-                GameLogic::applyBid(sim_state, bid);
-            }
-            else { // Playing phase during rollout
-                std::vector<int> valid_moves = GameLogic::getValidMoves(sim_state);
-                if (valid_moves.empty()) { // Should not happen in a valid game, but guard against infinite loops
-                    break;
+        // Leaves valued by the fused policy+value model skip the rollout entirely.
+        if (!leaf_evaluated) {
+            int current_rollout_player_idx = sim_state.currentPlayerIndex; // Track who's turn it is in the rollout
+
+            while (!GameLogic::isGameOver(sim_state) && !GameLogic::isRoundOver(sim_state)) {
+                if (sim_state.bidsMade < 4) { // Bidding phase during rollout
+                    int bid = rollout_bot.getBid(sim_state.players[current_rollout_player_idx], sim_state);
+                    GameLogic::applyBid(sim_state, bid);
+                }
+                else { // Playing phase during rollout
+                    // A decided ending needs no random play: credit it and stop
+                    std::array<int, 4> claimed;
+                    if (sim_state.currentTrick.empty() && GameLogic::findClaim(sim_state, claimed)) {
+                        GameLogic::applyClaim(sim_state, claimed);
+                        break;
+                    }
+                    // Late enough, perfect play from here is cheap to find: credit each
+                    // team's tricks to one of its players whose tricks count for the
+                    // contract, i.e. not to a nil bidder who has already failed
+                    if (sim_state.currentTrick.empty() && ddSolver &&
+                        static_cast<int>(sim_state.players[sim_state.currentPlayerIndex].hand.size()) <= ddRolloutTricks &&
+                        std::none_of(sim_state.players.begin(), sim_state.players.end(),
+                                     [](const Player& p) { return p.bid == 0 && p.tricksWon == 0; })) {
+                        std::array<int, 2> team_tricks = ddSolver->solve(sim_state);
+                        claimed.fill(0);
+                        for (int team = 0; team < 2; ++team) {
+                            claimed[sim_state.players[team].bid != 0 ? team : team + 2] = team_tricks[team];
+                        }
+                        GameLogic::applyClaim(sim_state, claimed);
+                        break;
+                    }
+                    std::vector<int> valid_moves = GameLogic::getValidMoves(sim_state);
+                    if (valid_moves.empty()) { // Should not happen in a valid game, but guard against infinite loops
+                        break;
+                    }
+                    int move_idx = rollout_bot.getMove(sim_state, valid_moves);
+                    GameLogic::applyMove(sim_state, move_idx);
                 }
-                int move_idx = rollout_bot.getMove(sim_state, valid_moves);
-                GameLogic::applyMove(sim_state, move_idx);
+                current_rollout_player_idx = sim_state.currentPlayerIndex; // Update for next turn in rollout
             }
-            current_rollout_player_idx = sim_state.currentPlayerIndex; // Update for next turn in rollout
-        }
 
-        // After rollout, calculate score and get win probability from NN3
-        int t1_round_points, t2_round_points; // dummy vars, will update state scores
-        GameLogic::updateScores(sim_state, t1_round_points, t2_round_points); // updates sim_state.teamXScore/Bags
+            // After rollout, calculate score and get win probability from NN3
+            int t1_round_points, t2_round_points; // dummy vars, will update state scores
+            GameLogic::updateScores(sim_state, t1_round_points, t2_round_points); // updates sim_state.teamXScore/Bags
 
-        int perspective_team_id = rootState.currentPlayerIndex % 2; // For NN3, we need perspective of the *root player's* team
-        auto nn3_features = stateToNN3Features(sim_state, perspective_team_id);
-        std::vector<int64_t> nn3_shape = { 1, 4 }; // Batch size 1, 4 features
+            // For NN3, we need perspective of the *root player's* team
+            std::vector<int64_t> nn3_shape = { 1, static_cast<int64_t>(FeatureEncoder::kValueFeatureCount) };
 
-        double value = 0.5; // Default if NN3 not available
-        if (nn3_model) {
-            auto result_vec = nn3_model->predict(nn3_features, nn3_shape);
-            if (!result_vec.empty()) {
-                value = result_vec[0]; // NN3 predicts win probability (0 to 1)
+            if (nn3_model) {
+                FeatureEncoder::encodeValue(sim_state, perspective_team_id, value_row);
+                auto result_vec = nn3_model->predict(value_row, nn3_shape);
+                if (!result_vec.empty()) {
+                    value = result_vec[0]; // NN3 predicts win probability (0 to 1)
+                }
             }
         }
 
-
         // 4. BACKPROPAGATION
         while (current_node != nullptr) {
             current_node->visit_count++;
@@ -331,17 +542,26 @@ std::unique_ptr<MCTSNode> MCTSBot::runMCTS(const GameState& rootState, bool isBi
 
     // Store policy and value from root node for training data
     lastActionProbs.assign(isBidding ? 14 : rootState.players[rootState.currentPlayerIndex].hand.size(), 0.0f);
+    lastVisitCounts.assign(lastActionProbs.size(), 0);
     float total_visits = 0.0f; // Initialize as float
     for (const auto& child : root->children) {
         if (isBidding && child->action_idx < 14) {
             lastActionProbs[child->action_idx] += static_cast<float>(child->visit_count); // Cast to float
+            lastVisitCounts[child->action_idx] += child->visit_count;
             total_visits += static_cast<float>(child->visit_count); // Cast to float
         }
         else if (!isBidding && child->action_idx < lastActionProbs.size()) { // For playing, action_idx is hand index
             lastActionProbs[child->action_idx] += static_cast<float>(child->visit_count); // Cast to float
+            lastVisitCounts[child->action_idx] += child->visit_count;
             total_visits += static_cast<float>(child->visit_count); // Cast to float
         }
     }
+    if (!isBidding && total_visits > 0) {
+        shareEquivalentVisits(rootState, lastVisitCounts);
+        for (size_t i = 0; i < lastActionProbs.size(); ++i) {
+            lastActionProbs[i] = static_cast<float>(lastVisitCounts[i]);
+        }
+    }
     if (total_visits > 0) {
         for (float& prob : lastActionProbs) {
             prob /= total_visits;
@@ -366,7 +586,12 @@ std::unique_ptr<MCTSNode> MCTSBot::runMCTS(const GameState& rootState, bool isBi
     }
 
     // Store the value from the root
-    lastValueEstimate = { (float)(root->value_sum / root->visit_count) };
+    if (root->visit_count > 0) {
+        lastValueEstimate = { (float)(root->value_sum / root->visit_count) };
+    }
+    else {
+        lastValueEstimate.clear();
+    }
 
 
     return root;
@@ -381,7 +606,7 @@ int MCTSBot::getBid(const Player& player, const GameState& state) {
     int max_visits = -1;
 
     // Iterate over children to find the best action (bid)
-    // The children are already sorted by action_idx implicitly due to expansion logic
+    // Children are in expansion order, so ties go to the bid NN1 favours
     for (const auto& child : root->children) {
         if (child->visit_count > max_visits) {
             max_visits = child->visit_count;
@@ -401,6 +626,33 @@ int MCTSBot::getBid(const Player& player, const GameState& state) {
 }
 
 int MCTSBot::getMove(const GameState& state, const std::vector<int>& validMoves) {
+    if (budgetOptions.enabled) {
+        size_t hand_size = state.players[state.currentPlayerIndex].hand.size();
+        std::vector<int> distinct_moves = GameLogic::getDistinctMoves(state);
+        if (distinct_moves.size() == 1) {
+            // Nothing to search: the whole budget goes to the bank
+            lastActionProbs.assign(hand_size, 0.0f);
+            for (int move : validMoves) {
+                lastActionProbs[move] = 1.0f / validMoves.size(); // All of them equivalent
+            }
+            lastVisitCounts.assign(hand_size, 0);
+            lastValueEstimate.clear();
+            lastSearchKind = SearchKind::Forced;
+            lastSimulations = 0;
+            bankSimulations(simulationsPerMove);
+            return distinct_moves[0];
+        }
+        if (budgetOptions.exact_solve_tricks > 0 && hand_size <= static_cast<size_t>(budgetOptions.exact_solve_tricks)) {
+            solveEndgame(state);
+            lastSearchKind = SearchKind::Solved;
+            lastSimulations = 0;
+            bankSimulations(simulationsPerMove);
+            for (int move : validMoves) {
+                if (lastVisitCounts[move] > 0) return move;
+            }
+        }
+    }
+
     auto root = runMCTS(state, false);
 
     // Choose the card play with the most visits
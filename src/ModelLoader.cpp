@@ -0,0 +1,118 @@
+#include "include/ModelLoader.hpp"
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+
+std::string resolveModelPath(const std::string& modelPath, const std::string& name, bool preferQuantized) {
+    std::string fp32_path = modelPath + "/" + name + "_model.onnx";
+    if (preferQuantized) {
+        std::string int8_path = modelPath + "/" + name + "_model.int8.onnx";
+        if (std::filesystem::exists(int8_path)) {
+            return int8_path;
+        }
+        std::cout << "No int8 model at " << int8_path << ", falling back to fp32." << std::endl;
+    }
+    return fp32_path;
+}
+
+// Builds and warms one model on the calling thread, returning how long it took.
+template <typename Model>
+static std::shared_ptr<Model> loadTimed(const std::string& path, const ModelLoadOptions& options, double& elapsed_ms) {
+    auto start = std::chrono::steady_clock::now();
+    auto model = std::make_shared<Model>(path, options.use_optimized_cache);
+    if (options.warmup) {
+        model->warmup();
+    }
+    if (options.inference_cache_bytes > 0) {
+        model->enableCache(options.inference_cache_bytes);
+    }
+    elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return model;
+}
+
+template <typename Model>
+static void reportLoaded(const std::string& label, const std::string& path, const std::shared_ptr<Model>& model, double elapsed_ms) {
+    std::cout << "Loaded " << label << " model from " << path << " in " << elapsed_ms << " ms"
+        << (model->loadedFromCache() ? " (cached optimized graph)." : ".") << std::endl;
+}
+
+ModelSet loadModelSet(const std::string& modelPath, const ModelLoadOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::string nn3_onnx_path = resolveModelPath(modelPath, "nn3", options.prefer_quantized);
+    std::string nn1_onnx_path = resolveModelPath(modelPath, "nn1", options.prefer_quantized);
+    std::string nn2_onnx_path = resolveModelPath(modelPath, "nn2", options.prefer_quantized);
+    std::string pv_onnx_path = resolveModelPath(modelPath, "pv", options.prefer_quantized);
+
+    // --- Check which models exist before starting any session ---
+    if (!std::filesystem::exists(nn3_onnx_path)) {
+        throw std::runtime_error("NN3 model not found at " + nn3_onnx_path + ". Cannot run self-play.");
+    }
+    if (options.fused && !std::filesystem::exists(pv_onnx_path)) {
+        throw std::runtime_error("--fused given but no policy+value model at " + pv_onnx_path + ".");
+    }
+    bool load_nn1 = std::filesystem::exists(nn1_onnx_path);
+    bool load_nn2 = !options.fused && std::filesystem::exists(nn2_onnx_path);
+
+    // --- Load the sessions concurrently; each one optimizes (or reads) its own graph ---
+    double nn1_ms = 0.0, nn2_ms = 0.0, nn3_ms = 0.0, pv_ms = 0.0;
+    auto nn3_future = std::async(std::launch::async, [&] { return loadTimed<ONNXModel>(nn3_onnx_path, options, nn3_ms); });
+    std::future<std::shared_ptr<ONNXModel>> nn1_future, nn2_future;
+    std::future<std::shared_ptr<PolicyValueModel>> pv_future;
+    if (load_nn1) {
+        nn1_future = std::async(std::launch::async, [&] { return loadTimed<ONNXModel>(nn1_onnx_path, options, nn1_ms); });
+    }
+    if (load_nn2) {
+        nn2_future = std::async(std::launch::async, [&] { return loadTimed<ONNXModel>(nn2_onnx_path, options, nn2_ms); });
+    }
+    if (options.fused) {
+        pv_future = std::async(std::launch::async, [&] { return loadTimed<PolicyValueModel>(pv_onnx_path, options, pv_ms); });
+    }
+
+    // get() rethrows any Ort::Exception from the loading thread.
+    ModelSet models;
+    models.nn3 = nn3_future.get();
+    reportLoaded("NN3", nn3_onnx_path, models.nn3, nn3_ms);
+
+    if (load_nn1) {
+        models.nn1 = nn1_future.get();
+        reportLoaded("NN1", nn1_onnx_path, models.nn1, nn1_ms);
+    }
+    else {
+        std::cout << "NN1 model not found at " << nn1_onnx_path << ". MCTS will use random rollouts for bidding policy." << std::endl;
+    }
+
+    if (options.fused) {
+        models.pv = pv_future.get();
+        reportLoaded("policy+value", pv_onnx_path, models.pv, pv_ms);
+        std::cout << "Skipping NN2; playing searches use the policy+value model." << std::endl;
+    }
+    else if (load_nn2) {
+        models.nn2 = nn2_future.get();
+        reportLoaded("NN2", nn2_onnx_path, models.nn2, nn2_ms);
+    }
+    else {
+        std::cout << "NN2 model not found at " << nn2_onnx_path << ". MCTS will use random rollouts for playing policy." << std::endl;
+    }
+
+    double total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Model startup complete in " << total_ms << " ms." << std::endl;
+    return models;
+}
+
+static void reportCache(const std::string& label, const InferenceCache* cache) {
+    if (!cache) return;
+    InferenceCacheStats stats = cache->stats();
+    std::cout << label << " cache: " << stats.hits << " hits / " << (stats.hits + stats.misses) << " lookups ("
+        << stats.hitRate() * 100.0 << "%), " << stats.entries << " entries, "
+        << stats.bytes / 1024 << " KiB, " << stats.evictions << " evictions" << std::endl;
+}
+
+void reportCacheStats(const ModelSet& models) {
+    if (models.nn1) reportCache("NN1", models.nn1->cache());
+    if (models.nn2) reportCache("NN2", models.nn2->cache());
+    if (models.nn3) reportCache("NN3", models.nn3->cache());
+    if (models.pv) reportCache("Policy+value", models.pv->cache());
+}
@@ -0,0 +1,78 @@
+#include "include/ModelWatcher.hpp"
+#include <iostream>
+
+ModelWatcher::ModelWatcher(const std::string& modelPath, const ModelLoadOptions& options, ModelSet initial,
+                           std::chrono::milliseconds pollInterval)
+    : model_path(modelPath), load_options(options), poll_interval(pollInterval),
+      models(std::make_shared<const ModelSet>(std::move(initial))) {
+    loaded_fingerprint = scan();
+    watcher_thread = std::thread(&ModelWatcher::watchLoop, this);
+}
+
+ModelWatcher::~ModelWatcher() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        stop_requested = true;
+    }
+    stop_cv.notify_all();
+    if (watcher_thread.joinable()) {
+        watcher_thread.join();
+    }
+}
+
+std::shared_ptr<const ModelSet> ModelWatcher::current() const {
+    return std::atomic_load(&models);
+}
+
+ModelWatcher::Fingerprint ModelWatcher::scan() const {
+    Fingerprint fingerprint;
+    for (const char* name : { "nn1", "nn2", "nn3", "pv" }) {
+        std::string path = resolveModelPath(model_path, name, false);
+        std::string int8_path = model_path + "/" + name + "_model.int8.onnx";
+        for (const std::string& candidate : { path, int8_path }) {
+            std::error_code ec;
+            auto mtime = std::filesystem::last_write_time(candidate, ec);
+            if (ec) continue;
+            auto size = std::filesystem::file_size(candidate, ec);
+            if (ec) continue;
+            fingerprint[candidate] = { mtime, size };
+        }
+    }
+    return fingerprint;
+}
+
+void ModelWatcher::watchLoop() {
+    // Only reload once the directory has looked the same for two polls in a row,
+    // so a checkpoint that is still being written is never picked up half-way.
+    Fingerprint pending;
+    std::unique_lock<std::mutex> lock(stop_mutex);
+    while (!stop_cv.wait_for(lock, poll_interval, [this] { return stop_requested; })) {
+        Fingerprint seen = scan();
+        if (seen == loaded_fingerprint) {
+            pending.clear();
+            continue;
+        }
+        if (seen != pending) {
+            pending = seen;
+            continue;
+        }
+
+        lock.unlock();
+        int generation = std::atomic_load(&models)->generation + 1;
+        std::cout << "Model change detected in " << model_path << ", loading generation " << generation << "..." << std::endl;
+        try {
+            ModelSet reloaded = loadModelSet(model_path, load_options);
+            reloaded.generation = generation;
+            std::atomic_store(&models, std::make_shared<const ModelSet>(std::move(reloaded)));
+            loaded_fingerprint = seen;
+            std::cout << "Switched to model generation " << generation << "." << std::endl;
+        }
+        catch (const std::exception& e) {
+            // Keep playing with the current generation; the next change retries.
+            std::cerr << "Model reload failed, keeping generation " << generation - 1 << ": " << e.what() << std::endl;
+            loaded_fingerprint = seen;
+        }
+        pending.clear();
+        lock.lock();
+    }
+}
@@ -1,15 +1,140 @@
 #include "include/ONNXModel.hpp"
 #include <stdexcept>
 #include <vector>
+#include <mutex>
+#include <filesystem>
+#include <random>
 
 // Helper function to convert std::string to std::wstring
 static std::wstring to_wstring(const std::string& str) {
     return std::wstring(str.begin(), str.end());
 }
 
-ONNXModel::ONNXModel(const std::string& model_path)
-    : env(ORT_LOGGING_LEVEL_WARNING, "SpadesBot"),
-      session(env, to_wstring(model_path).c_str(), Ort::SessionOptions()) {
+// --- Shared Runtime ---
+// A single Ort::Env per process: with the global thread pool enabled, NN1/NN2/NN3
+// all run on one intra-op/inter-op pool instead of each spinning up its own.
+
+static std::mutex runtime_mutex;
+static ONNXSessionConfig runtime_config;
+static std::unique_ptr<Ort::Env> runtime_env;
+
+void ONNXModel::configureRuntime(const ONNXSessionConfig& config) {
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    if (runtime_env) {
+        throw std::runtime_error("ONNXModel::configureRuntime called after the ONNX Runtime environment was created.");
+    }
+    runtime_config = config;
+}
+
+Ort::Env& ONNXModel::sharedEnv() {
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    if (!runtime_env) {
+        if (runtime_config.use_global_thread_pool) {
+            Ort::ThreadingOptions threading_options;
+            threading_options.SetGlobalIntraOpNumThreads(runtime_config.intra_op_threads);
+            threading_options.SetGlobalInterOpNumThreads(runtime_config.inter_op_threads);
+            runtime_env = std::make_unique<Ort::Env>(threading_options, ORT_LOGGING_LEVEL_WARNING, "SpadesBot");
+        }
+        else {
+            runtime_env = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "SpadesBot");
+        }
+
+        if (runtime_config.share_arena_across_sessions) {
+            auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+            Ort::ArenaCfg arena_cfg(runtime_config.arena_max_bytes, runtime_config.arena_extend_strategy, -1, -1);
+            runtime_env->CreateAndRegisterAllocator(memory_info, arena_cfg);
+        }
+    }
+    return *runtime_env;
+}
+
+Ort::SessionOptions ONNXModel::makeSessionOptions() {
+    Ort::SessionOptions options;
+    if (runtime_config.use_global_thread_pool) {
+        options.DisablePerSessionThreads();
+    }
+    else {
+        options.SetIntraOpNumThreads(runtime_config.intra_op_threads);
+        options.SetInterOpNumThreads(runtime_config.inter_op_threads);
+    }
+    options.SetGraphOptimizationLevel(runtime_config.graph_optimization_level);
+    options.SetExecutionMode(runtime_config.execution_mode);
+
+    if (runtime_config.enable_cpu_mem_arena) {
+        options.EnableCpuMemArena();
+    }
+    else {
+        options.DisableCpuMemArena();
+    }
+    if (runtime_config.enable_mem_pattern) {
+        options.EnableMemPattern();
+    }
+    else {
+        options.DisableMemPattern();
+    }
+    if (runtime_config.share_arena_across_sessions) {
+        options.AddConfigEntry("session.use_env_allocators", "1");
+    }
+    return options;
+}
+
+// --- Optimized Graph Cache ---
+
+// The optimized graph depends on the session options, so they are part of the name:
+// a process configured differently never loads another's cache. Sessions always
+// run on the CPU execution provider.
+std::string ONNXModel::optimizedCachePath(const std::string& model_path) {
+    std::string key = "cpu-L" + std::to_string(static_cast<int>(runtime_config.graph_optimization_level));
+    key += runtime_config.execution_mode == ORT_PARALLEL ? "-par" : "-seq";
+    key += "-t" + std::to_string(runtime_config.intra_op_threads) + "x" + std::to_string(runtime_config.inter_op_threads);
+    key += runtime_config.use_global_thread_pool ? "-global" : "-session";
+    std::filesystem::path path(model_path);
+    path.replace_extension(".opt-" + key + ".ort");
+    return path.string();
+}
+
+// Opens the session from the serialized optimized graph when it is up to date,
+// otherwise optimizes the .onnx and (if caching) writes the cache for next time.
+static Ort::Session openSession(const std::string& model_path, const std::string& cache_path,
+                                Ort::Env& env, Ort::SessionOptions options, bool use_cache, bool& loaded_from_cache) {
+    namespace fs = std::filesystem;
+    loaded_from_cache = false;
+    if (!use_cache) {
+        return Ort::Session(env, to_wstring(model_path).c_str(), options);
+    }
+
+    std::error_code ec;
+    if (fs::exists(cache_path, ec) && fs::last_write_time(cache_path, ec) >= fs::last_write_time(model_path, ec) && !ec) {
+        try {
+            Ort::SessionOptions load_options = options.Clone();
+            load_options.AddConfigEntry("session.load_model_format", "ORT");
+            Ort::Session cached(env, to_wstring(cache_path).c_str(), load_options);
+            loaded_from_cache = true;
+            return cached;
+        }
+        catch (const Ort::Exception&) {
+            // Stale or unreadable cache (e.g. written by another ORT version); rebuild it below.
+        }
+    }
+
+    // Write to a unique temporary name and rename, so concurrently starting shards
+    // never observe a half-written cache file.
+    std::string tmp_path = cache_path + ".tmp" + std::to_string(std::random_device{}());
+    Ort::SessionOptions save_options = options.Clone();
+    save_options.AddConfigEntry("session.save_model_format", "ORT");
+    save_options.SetOptimizedModelFilePath(to_wstring(tmp_path).c_str());
+    Ort::Session session(env, to_wstring(model_path).c_str(), save_options);
+
+    fs::rename(tmp_path, cache_path, ec);
+    if (ec) {
+        fs::remove(tmp_path, ec); // Another process won the race; its cache is equivalent.
+    }
+    return session;
+}
+
+ONNXModel::ONNXModel(const std::string& model_path, bool use_optimized_cache)
+    : session(openSession(model_path, optimizedCachePath(model_path), sharedEnv(), makeSessionOptions(),
+                          use_optimized_cache, loaded_from_cache)) {
 
     Ort::AllocatorWithDefaultOptions allocator;
 
@@ -35,6 +160,27 @@ ONNXModel::ONNXModel(const std::string& model_path)
 }
 
 std::vector<float> ONNXModel::predict(const std::vector<float>& input_data, const std::vector<int64_t>& input_shape) {
+    return predictAll(input_data, input_shape).front();
+}
+
+void ONNXModel::enableCache(size_t max_bytes) {
+    inference_cache = max_bytes > 0 ? std::make_unique<InferenceCache>(max_bytes) : nullptr;
+}
+
+std::vector<std::vector<float>> ONNXModel::predictAll(const std::vector<float>& input_data, const std::vector<int64_t>& input_shape) {
+    if (!inference_cache) {
+        return runSession(input_data, input_shape);
+    }
+    std::vector<std::vector<float>> outputs;
+    if (inference_cache->lookup(input_data, input_shape, outputs)) {
+        return outputs;
+    }
+    outputs = runSession(input_data, input_shape);
+    inference_cache->insert(input_data, input_shape, outputs);
+    return outputs;
+}
+
+std::vector<std::vector<float>> ONNXModel::runSession(const std::vector<float>& input_data, const std::vector<int64_t>& input_shape) {
     auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
 
     Ort::Value input_tensor = Ort::Value::CreateTensor<float>(
@@ -51,8 +197,25 @@ std::vector<float> ONNXModel::predict(const std::vector<float>& input_data, cons
         output_node_names.data(), output_node_names.size()
     );
 
-    float* floatarr = output_tensors[0].GetTensorMutableData<float>();
-    size_t output_size = output_tensors[0].GetTensorTypeAndShapeInfo().GetElementCount();
+    std::vector<std::vector<float>> outputs;
+    outputs.reserve(output_tensors.size());
+    for (auto& tensor : output_tensors) {
+        float* floatarr = tensor.GetTensorMutableData<float>();
+        size_t output_size = tensor.GetTensorTypeAndShapeInfo().GetElementCount();
+        outputs.emplace_back(floatarr, floatarr + output_size);
+    }
+    return outputs;
+}
 
-    return std::vector<float>(floatarr, floatarr + output_size);
+void ONNXModel::warmup() {
+    auto shape = session.GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    size_t element_count = 1;
+    for (auto& dim : shape) {
+        if (dim <= 0) {
+            dim = 1; // Dynamic axes (batch_size) become a batch of one
+        }
+        element_count *= static_cast<size_t>(dim);
+    }
+    std::vector<float> dummy_input(element_count, 0.0f);
+    runSession(dummy_input, shape);
 }
\ No newline at end of file
@@ -0,0 +1,282 @@
+#include "include/PIMCBot.hpp"
+#include "include/GameLogic.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Gives a team's tricks to a member whose tricks count for the contract: a nil bidder's
+// do not, and a nil still at risk is taken to hold.
+static void creditTricks(GameState& scored, int team, int tricks) {
+    Player& first = scored.players[team];
+    Player& second = scored.players[team + 2];
+    Player& taker = first.bid != 0 ? first : (second.bid != 0 || second.tricksWon > 0 ? second : first);
+    taker.tricksWon += tricks;
+}
+
+// Round points of `team` minus the other team's, once `scored` holds the final tricks
+static int roundMargin(GameState scored, int team) {
+    int team1RoundPoints = 0, team2RoundPoints = 0;
+    GameLogic::updateScores(scored, team1RoundPoints, team2RoundPoints);
+    return team == 0 ? team1RoundPoints - team2RoundPoints : team2RoundPoints - team1RoundPoints;
+}
+
+// Rough trick-taking weight of a hand, to split a team contract between the partners
+static int highCardStrength(const std::vector<Card>& hand) {
+    int strength = 0, spades = 0;
+    for (const Card& card : hand) {
+        strength += std::max(0, static_cast<int>(card.rank) - static_cast<int>(Rank::TEN));
+        spades += card.suit == Suit::SPADES ? 1 : 0;
+    }
+    return strength + std::max(0, spades - 3);
+}
+
+PIMCBot::PIMCBot(const PIMCOptions& options) : options(options) {
+    int count = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    count = std::max(1, count);
+    uint32_t seed = options.seed != 0 ? options.seed : std::random_device{}();
+    for (int w = 0; w < count; ++w) {
+        std::seed_seq worker_seed{ seed, static_cast<uint32_t>(w) };
+        rngs.emplace_back(worker_seed);
+        solvers.push_back(std::make_unique<DoubleDummySolver>());
+    }
+    for (int w = 1; w < count; ++w) {
+        workers.emplace_back(&PIMCBot::workerLoop, this, w);
+    }
+}
+
+PIMCBot::~PIMCBot() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// --- Thread Pool ---
+
+void PIMCBot::runTasks(int worker) {
+    try {
+        for (int i = next_task++; i < task_count; i = next_task++) {
+            (*task)(worker, i);
+        }
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failure) failure = std::current_exception();
+        next_task = task_count; // The others stop after their current sample
+    }
+}
+
+void PIMCBot::workerLoop(int worker) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runTasks(worker);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy_workers == 0) work_done.notify_one();
+    }
+}
+
+void PIMCBot::runSamples(int count, const std::function<void(int, int)>& sample_task) {
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &sample_task;
+        task_count = count;
+        next_task = 0;
+        busy_workers = static_cast<int>(workers.size());
+        failure = nullptr;
+        ++generation;
+    }
+    work_ready.notify_all();
+    runTasks(0);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        work_done.wait(lock, [&] { return busy_workers == 0; });
+        task = nullptr;
+    }
+    if (failure) std::rethrow_exception(failure);
+    samples_solved += static_cast<uint64_t>(count);
+    solve_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// --- Sampling ---
+
+// A player who did not follow the suit led has none left. Only the trick in progress
+// shows who played what, so voids are gathered one decision at a time and forgotten
+// when a new deal starts.
+void PIMCBot::observe(const GameState& state) {
+    int out = 0;
+    for (const Player& player : state.players) {
+        out += static_cast<int>(player.hand.size());
+    }
+    if (out > cards_out) {
+        void_suits.fill(0);
+    }
+    cards_out = out;
+    if (state.currentTrick.empty()) return;
+    Suit led = state.currentTrick[0].suit;
+    for (size_t i = 1; i < state.currentTrick.size(); ++i) {
+        if (state.currentTrick[i].suit != led) {
+            void_suits[(state.trickLeaderIndex + i) % 4] |= static_cast<uint8_t>(1u << static_cast<int>(led));
+        }
+    }
+}
+
+GameState PIMCBot::sampleDeal(const GameState& state, int observer, std::mt19937& rng) const {
+    GameState deal = state;
+    deal.deck.clear();
+    std::vector<Card> unseen;
+    std::array<size_t, 4> sizes{};
+    for (int p = 0; p < 4; ++p) {
+        if (p == observer) continue;
+        sizes[p] = deal.players[p].hand.size();
+        unseen.insert(unseen.end(), deal.players[p].hand.begin(), deal.players[p].hand.end());
+    }
+
+    // Each card goes to a player with room who may hold its suit, chosen in proportion
+    // to the room left. That can paint itself into a corner, so it is retried; should
+    // it keep failing, the voids are let go.
+    for (int attempt = 0; attempt < 64; ++attempt) {
+        std::shuffle(unseen.begin(), unseen.end(), rng);
+        bool relax = attempt == 63;
+        std::array<size_t, 4> room = sizes;
+        for (int p = 0; p < 4; ++p) {
+            if (p != observer) deal.players[p].hand.clear();
+        }
+        bool dealt = true;
+        for (const Card& card : unseen) {
+            std::array<size_t, 4> weight{};
+            size_t total = 0;
+            for (int p = 0; p < 4; ++p) {
+                bool allowed = relax || !(void_suits[p] >> static_cast<int>(card.suit) & 1);
+                weight[p] = allowed ? room[p] : 0;
+                total += weight[p];
+            }
+            if (total == 0) {
+                dealt = false;
+                break;
+            }
+            size_t pick = std::uniform_int_distribution<size_t>(0, total - 1)(rng);
+            int p = 0;
+            while (pick >= weight[p]) pick -= weight[p++];
+            deal.players[p].hand.push_back(card);
+            room[p]--;
+        }
+        if (dealt) break;
+    }
+    return deal;
+}
+
+// --- Decisions ---
+
+int PIMCBot::getBid(const Player& player, const GameState& state) {
+    observe(state);
+    int me = state.currentPlayerIndex;
+    for (int p = 0; p < 4; ++p) {
+        if (&state.players[p] == &player) me = p;
+    }
+    int partner = (me + 2) % 4;
+    // Bids go round from the opening leader
+    bool partner_bid = (partner - state.trickLeaderIndex + 4) % 4 < state.bidsMade;
+
+    int count = std::max(1, options.samples);
+    std::vector<int> team_tricks(count);
+    std::vector<double> shares(count);
+    runSamples(count, [&](int worker, int sample) {
+        GameState deal = sampleDeal(state, me, rngs[worker]);
+        deal.currentTrick.clear();
+        deal.currentPlayerIndex = deal.trickLeaderIndex;
+        team_tricks[sample] = solvers[worker]->solve(deal)[me % 2];
+        int mine = highCardStrength(deal.players[me].hand);
+        int theirs = highCardStrength(deal.players[partner].hand);
+        shares[sample] = mine + theirs > 0 ? static_cast<double>(mine) / (mine + theirs) : 0.5;
+    });
+
+    // The contract worth the most over the sampled trick counts. Before partner has
+    // bid, this bid stands for the whole contract; partner's turn settles it.
+    GameState scored = state;
+    scored.deck.clear();
+    scored.currentTrick.clear();
+    for (auto& p : scored.players) {
+        p.hand.clear();
+        p.tricksWon = 0;
+    }
+    scored.players[partner].bid = partner_bid ? state.players[partner].bid : 0;
+    int best_bid = 1;
+    double best_value = -1e9;
+    for (int bid = 1; bid <= 13; ++bid) {
+        scored.players[me].bid = bid;
+        double value = 0.0;
+        for (int tricks : team_tricks) {
+            GameState outcome = scored;
+            creditTricks(outcome, me % 2, tricks);
+            value += roundMargin(outcome, me % 2);
+        }
+        if (value > best_value) {
+            best_value = value;
+            best_bid = bid;
+        }
+    }
+    if (partner_bid) return best_bid;
+    double share = 0.0;
+    for (double s : shares) share += s;
+    share /= count;
+    return std::clamp(static_cast<int>(std::lround(best_bid * share)), 1, 13);
+}
+
+int PIMCBot::getMove(const GameState& state, const std::vector<int>& validMoves) {
+    observe(state);
+    if (validMoves.size() <= 1) {
+        return validMoves.empty() ? 0 : validMoves[0];
+    }
+    int me = state.currentPlayerIndex;
+    const auto& hand = state.players[me].hand;
+    int remaining = static_cast<int>(hand.size()); // The trick in progress included
+
+    // What the round looks like once the rest of the tricks are credited
+    GameState scored = state;
+    scored.deck.clear();
+    scored.currentTrick.clear();
+    for (auto& p : scored.players) {
+        p.hand.clear();
+    }
+    // Margin per split of the remaining tricks: the same for every deal
+    std::vector<int> margin_for(remaining + 1);
+    for (int tricks = 0; tricks <= remaining; ++tricks) {
+        GameState outcome = scored;
+        creditTricks(outcome, me % 2, tricks);
+        creditTricks(outcome, 1 - me % 2, remaining - tricks);
+        margin_for[tricks] = roundMargin(outcome, me % 2);
+    }
+
+    int count = std::max(1, options.samples);
+    std::vector<std::vector<int>> card_tricks(count);
+    runSamples(count, [&](int worker, int sample) {
+        GameState deal = sampleDeal(state, me, rngs[worker]);
+        card_tricks[sample] = solvers[worker]->solveMoves(deal);
+    });
+
+    int best = validMoves[0];
+    double best_margin = -1e9;
+    for (int move : validMoves) {
+        double margin = 0.0;
+        for (const auto& tricks : card_tricks) {
+            margin += margin_for[std::max(0, tricks[move])];
+        }
+        // Of cards that do as well, the lowest gives away the least
+        if (margin > best_margin || (margin == best_margin && hand[move].rank < hand[best].rank)) {
+            best_margin = margin;
+            best = move;
+        }
+    }
+    return best;
+}
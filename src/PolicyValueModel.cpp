@@ -0,0 +1,22 @@
+#include "include/PolicyValueModel.hpp"
+#include <stdexcept>
+
+PolicyValueModel::PolicyValueModel(const std::string& model_path, bool use_optimized_cache)
+    : model(model_path, use_optimized_cache) {
+    // Outputs are exported as ('policy', 'value'); anything else is a single-headed model.
+    if (model.outputCount() != 2) {
+        throw std::runtime_error("Policy+value model must have exactly two outputs (policy, value): " + model_path);
+    }
+}
+
+PolicyValueOutput PolicyValueModel::evaluate(const std::vector<float>& features) {
+    std::vector<int64_t> shape = { 1, static_cast<int64_t>(features.size()) };
+    auto outputs = model.predictAll(features, shape);
+
+    PolicyValueOutput result;
+    result.policy = std::move(outputs[0]);
+    if (!outputs[1].empty()) {
+        result.value = outputs[1][0];
+    }
+    return result;
+}
@@ -0,0 +1,162 @@
+#include "include/ReplayBuffer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+ReplayBuffer::ReplayBuffer(const ReplayBufferOptions& options)
+    : shard_capacity(std::max<size_t>(1, options.capacity / std::max<size_t>(1, options.shards))) {
+    size_t shard_count = std::max<size_t>(1, options.shards);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards.push_back(std::make_unique<Shard>());
+        shards.back()->slots = std::make_unique<Slot[]>(shard_capacity);
+    }
+    recency_half_life = options.recency_half_life > 0 ? options.recency_half_life : static_cast<double>(capacity()) / 4.0;
+}
+
+// Threads are bound to shards round-robin on their first insert.
+size_t ReplayBuffer::shardForThisThread() const {
+    thread_local const ReplayBuffer* owner = nullptr;
+    thread_local size_t shard = 0;
+    if (owner != this) {
+        owner = this;
+        shard = next_shard.fetch_add(1, std::memory_order_relaxed) % shards.size();
+    }
+    return shard;
+}
+
+void ReplayBuffer::insert(Shard& shard, const CompactRecord& record, const CompactPolicyEntry* entries) {
+    uint64_t payload[kSlotWords] = {};
+    std::memcpy(payload, &record, sizeof(CompactRecord));
+    std::memcpy(reinterpret_cast<char*>(payload) + sizeof(CompactRecord), entries,
+                std::min<size_t>(record.policy_entries, 14) * sizeof(CompactPolicyEntry));
+
+    uint64_t position = shard.head.load(std::memory_order_relaxed);
+    Slot& slot = shard.slots[position % shard_capacity];
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.position.store(position, std::memory_order_relaxed);
+    for (size_t i = 0; i < kSlotWords; ++i) {
+        slot.words[i].store(payload[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    shard.head.store(position + 1, std::memory_order_release);
+}
+
+void ReplayBuffer::writeGame(const std::vector<TrainingSample>& samples) {
+    Shard& shard = *shards[shardForThisThread()];
+    // Uncontended unless more writer threads than shards exist
+    while (shard.writing.exchange(true, std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    std::vector<CompactPolicyEntry> entries;
+    for (const auto& sample : samples) {
+        CompactRecord record;
+        entries.clear();
+        if (CompactCodec::encode(sample, record, entries)) {
+            insert(shard, record, entries.data());
+        }
+        else {
+            skipped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    shard.writing.store(false, std::memory_order_release);
+}
+
+// Fails if the slot stays mid-write or has since been reused for a newer position.
+bool ReplayBuffer::readSlot(const Shard& shard, uint64_t position, CompactRecord& record, CompactPolicyEntry* entries) const {
+    const Slot& slot = shard.slots[position % shard_capacity];
+    uint64_t payload[kSlotWords];
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue; // Mid-write
+        }
+        uint64_t stored_position = slot.position.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < kSlotWords; ++i) {
+            payload[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) {
+            continue;
+        }
+        if (stored_position != position) {
+            return false; // Overwritten since the caller's snapshot of head
+        }
+        std::memcpy(&record, payload, sizeof(CompactRecord));
+        size_t count = std::min<size_t>(record.policy_entries, 14);
+        std::memcpy(entries, reinterpret_cast<const char*>(payload) + sizeof(CompactRecord), count * sizeof(CompactPolicyEntry));
+        record.policy_entries = static_cast<uint8_t>(count);
+        return true;
+    }
+    return false;
+}
+
+size_t ReplayBuffer::sample(size_t count, ReplaySampling mode, std::mt19937_64& rng,
+                            std::vector<CompactRecord>& records, std::vector<CompactPolicyEntry>& policy) const {
+    // Snapshot of each shard's fill; later inserts only make some draws a little newer.
+    std::vector<uint64_t> heads(shards.size());
+    std::vector<uint64_t> cumulative(shards.size());
+    uint64_t total = 0;
+    size_t active_shards = 0;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        heads[i] = shards[i]->head.load(std::memory_order_acquire);
+        uint64_t filled = std::min<uint64_t>(heads[i], shard_capacity);
+        active_shards += filled > 0;
+        total += filled;
+        cumulative[i] = total;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    // Samples of one shard are about active_shards inserts apart in global age.
+    double shard_half_life = std::max(1.0, recency_half_life / static_cast<double>(active_shards));
+    std::geometric_distribution<uint64_t> age_dist(1.0 - std::exp2(-1.0 / shard_half_life));
+    std::uniform_int_distribution<uint64_t> pick(0, total - 1);
+
+    CompactRecord record;
+    CompactPolicyEntry entries[14];
+    size_t drawn = 0;
+    for (size_t attempt = 0; drawn < count && attempt < count * 4; ++attempt) {
+        uint64_t r = pick(rng);
+        size_t s = std::upper_bound(cumulative.begin(), cumulative.end(), r) - cumulative.begin();
+        uint64_t filled = std::min<uint64_t>(heads[s], shard_capacity);
+        uint64_t position;
+        if (mode == ReplaySampling::Recency) {
+            uint64_t age = age_dist(rng);
+            if (age >= filled) {
+                continue; // Older than anything held; draw again
+            }
+            position = heads[s] - 1 - age;
+        }
+        else {
+            uint64_t offset = r - (cumulative[s] - filled);
+            position = heads[s] - filled + offset;
+        }
+        if (!readSlot(*shards[s], position, record, entries)) {
+            continue;
+        }
+        records.push_back(record);
+        policy.insert(policy.end(), entries, entries + record.policy_entries);
+        drawn++;
+    }
+    return drawn;
+}
+
+uint64_t ReplayBuffer::inserted() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard->head.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t ReplayBuffer::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        total += static_cast<size_t>(std::min<uint64_t>(shard->head.load(std::memory_order_relaxed), shard_capacity));
+    }
+    return total;
+}
@@ -0,0 +1,176 @@
+#include "include/ReplayServer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+static void closeSocket(intptr_t s) { closesocket(static_cast<SOCKET>(s)); }
+static void shutdownSocket(intptr_t s) { shutdown(static_cast<SOCKET>(s), SD_BOTH); }
+static bool validSocket(intptr_t s) { return static_cast<SOCKET>(s) != INVALID_SOCKET; }
+static constexpr int kSendFlags = 0;
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+static void closeSocket(intptr_t s) { ::close(static_cast<int>(s)); }
+static void shutdownSocket(intptr_t s) { ::shutdown(static_cast<int>(s), SHUT_RDWR); }
+static bool validSocket(intptr_t s) { return s >= 0; }
+static constexpr int kSendFlags = MSG_NOSIGNAL; // A vanished trainer must not SIGPIPE the self-play process
+#endif
+
+static bool sendAll(intptr_t s, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        int sent = ::send(s, bytes, static_cast<int>(std::min<size_t>(size, 1 << 20)), kSendFlags);
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+static bool recvAll(intptr_t s, void* data, size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        int received = ::recv(s, bytes, static_cast<int>(size), 0);
+        if (received <= 0) return false;
+        bytes += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+#pragma pack(push, 1)
+struct ReplayRequest {
+    char magic[4];
+    uint32_t count;
+    uint8_t mode;
+    uint8_t reserved[3];
+};
+struct ReplayResponseHeader {
+    uint32_t count;
+    uint32_t policy_entries;
+    uint64_t inserted;
+};
+#pragma pack(pop)
+
+ReplayServer::ReplayServer(const ReplayBuffer& buffer, uint16_t port, const std::string& bind_address)
+    : buffer(buffer) {
+#ifdef _WIN32
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+        throw std::runtime_error("WSAStartup failed.");
+    }
+#endif
+    listener = static_cast<Socket>(::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+    if (!validSocket(listener)) {
+        throw std::runtime_error("Could not create the replay buffer socket.");
+    }
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (inet_pton(AF_INET, bind_address.c_str(), &address.sin_addr) != 1 ||
+        ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, 8) != 0) {
+        closeSocket(listener);
+        throw std::runtime_error("Could not listen on " + bind_address + ":" + std::to_string(port) + " for replay buffer clients.");
+    }
+    accept_thread = std::thread(&ReplayServer::acceptLoop, this);
+}
+
+ReplayServer::~ReplayServer() {
+    stop();
+}
+
+void ReplayServer::stop() {
+    if (stopping.exchange(true)) return;
+    shutdownSocket(listener); // Wakes the blocking accept
+    if (accept_thread.joinable()) {
+        accept_thread.join();
+    }
+    closeSocket(listener);
+    std::vector<std::thread> finished;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        for (Socket client : clients) {
+            shutdownSocket(client); // Unblocks the client thread's recv
+        }
+        finished.swap(client_threads);
+    }
+    for (auto& t : finished) {
+        t.join();
+    }
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+void ReplayServer::acceptLoop() {
+    while (!stopping.load()) {
+        Socket client = static_cast<Socket>(::accept(listener, nullptr, nullptr));
+        if (!validSocket(client)) {
+            continue; // Listener closed by stop(), or a transient failure
+        }
+        int no_delay = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+        std::vector<std::thread> reaped;
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            if (stopping.load()) {
+                closeSocket(client);
+                break;
+            }
+            // Threads of clients that have disconnected are joined here rather than
+            // piling up until stop()
+            auto done = std::partition(client_threads.begin(), client_threads.end(), [&](const std::thread& t) {
+                return std::find(finished_clients.begin(), finished_clients.end(), t.get_id()) == finished_clients.end();
+            });
+            std::move(done, client_threads.end(), std::back_inserter(reaped));
+            client_threads.erase(done, client_threads.end());
+            finished_clients.clear();
+            clients.push_back(client);
+            client_threads.emplace_back(&ReplayServer::serveClient, this, client);
+        }
+        for (auto& t : reaped) {
+            t.join();
+        }
+    }
+}
+
+void ReplayServer::serveClient(Socket client) {
+    std::seed_seq seed{ std::random_device{}(), std::random_device{}() };
+    std::mt19937_64 rng(seed);
+    std::vector<CompactRecord> records;
+    std::vector<CompactPolicyEntry> policy;
+    ReplayRequest request;
+    while (!stopping.load() && recvAll(client, &request, sizeof(request)) && std::memcmp(request.magic, "RBQ1", 4) == 0) {
+        records.clear();
+        policy.clear();
+        ReplaySampling mode = request.mode == 1 ? ReplaySampling::Recency : ReplaySampling::Uniform;
+        buffer.sample(std::min(request.count, kMaxBatch), mode, rng, records, policy);
+
+        ReplayResponseHeader header{ static_cast<uint32_t>(records.size()), static_cast<uint32_t>(policy.size()), buffer.inserted() };
+        if (!sendAll(client, &header, sizeof(header)) ||
+            !sendAll(client, records.data(), records.size() * sizeof(CompactRecord)) ||
+            !sendAll(client, policy.data(), policy.size() * sizeof(CompactPolicyEntry))) {
+            break;
+        }
+        if (!records.empty()) {
+            batches_served++;
+        }
+    }
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    clients.erase(std::remove(clients.begin(), clients.end(), client), clients.end());
+    finished_clients.push_back(std::this_thread::get_id());
+    closeSocket(client);
+}
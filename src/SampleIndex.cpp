@@ -0,0 +1,160 @@
+#include "include/SampleIndex.hpp"
+#include "include/test.pb.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+static constexpr char kIndexMagic[8] = { 'S', 'P', 'D', 'I', 'D', 'X', '1', '\0' };
+
+struct SampleIndexHeader {
+    char magic[8];
+    uint32_t entry_bytes;
+    uint32_t reserved;
+};
+static_assert(sizeof(SampleIndexHeader) == 16, "SampleIndexHeader layout is part of the file format");
+
+static bool readHeader(std::FILE* file) {
+    SampleIndexHeader header;
+    return std::fread(&header, sizeof(header), 1, file) == 1 &&
+        std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) == 0 &&
+        header.entry_bytes == sizeof(SampleIndexEntry);
+}
+
+static bool writeHeader(std::FILE* file) {
+    SampleIndexHeader header{};
+    std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+    header.entry_bytes = sizeof(SampleIndexEntry);
+    return std::fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+std::string SampleIndex::pathFor(const std::string& data_path) {
+    return data_path + ".idx";
+}
+
+bool SampleIndex::isCurrent(const std::string& data_path, SampleIndexEntry* last) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    uint64_t data_size = fs::file_size(data_path, ec);
+    if (ec) return false;
+    uint64_t index_size = fs::file_size(pathFor(data_path), ec);
+    if (ec || index_size < sizeof(SampleIndexHeader) || (index_size - sizeof(SampleIndexHeader)) % sizeof(SampleIndexEntry) != 0) {
+        return false;
+    }
+
+    std::FILE* index = std::fopen(pathFor(data_path).c_str(), "rb");
+    if (!index) return false;
+    bool ok = readHeader(index);
+    uint64_t entries = (index_size - sizeof(SampleIndexHeader)) / sizeof(SampleIndexEntry);
+    SampleIndexEntry entry{};
+    if (ok && entries > 0) {
+        ok = std::fseek(index, static_cast<long>(-static_cast<long>(sizeof(SampleIndexEntry))), SEEK_END) == 0 &&
+            std::fread(&entry, sizeof(entry), 1, index) == 1;
+    }
+    std::fclose(index);
+    if (!ok) return false;
+    if (entries == 0) return data_size == 0;
+
+    // The last indexed record must end exactly at the end of the data file.
+    std::ifstream data(data_path, std::ios::binary);
+    int32_t size = 0;
+    data.seekg(static_cast<std::streamoff>(entry.offset));
+    if (!data.read(reinterpret_cast<char*>(&size), sizeof(size)) || size < 0 ||
+        entry.offset + sizeof(size) + static_cast<uint64_t>(size) != data_size) {
+        return false;
+    }
+    if (last) *last = entry;
+    return true;
+}
+
+bool SampleIndex::load(const std::string& data_path, std::vector<SampleIndexEntry>& entries) {
+    std::FILE* index = std::fopen(pathFor(data_path).c_str(), "rb");
+    if (!index) return false;
+    entries.clear();
+    bool ok = readHeader(index);
+    SampleIndexEntry chunk[4096];
+    size_t read = 0;
+    while (ok && (read = std::fread(chunk, sizeof(SampleIndexEntry), 4096, index)) > 0) {
+        entries.insert(entries.end(), chunk, chunk + read);
+    }
+    std::fclose(index);
+    return ok;
+}
+
+// A new game starts with its first bid: scores and bags at zero, nobody has bid yet.
+static bool startsGame(const TrainingSample& sample) {
+    if (!sample.is_bidding() || sample.state_features_size() < 8) return false;
+    for (int i = 0; i < 4; ++i) {
+        if (sample.state_features(i) != 0.0f || sample.state_features(4 + i) != -1.0f) return false;
+    }
+    return true;
+}
+
+uint64_t SampleIndex::rebuild(const std::string& data_path, uint64_t* indexed_bytes) {
+    std::ifstream data(data_path, std::ios::binary);
+    if (!data.is_open()) {
+        throw std::runtime_error("Could not open " + data_path + " to index it.");
+    }
+    std::string tmp_path = pathFor(data_path) + ".tmp";
+    std::FILE* index = std::fopen(tmp_path.c_str(), "wb");
+    if (!index || !writeHeader(index)) {
+        if (index) std::fclose(index);
+        throw std::runtime_error("Could not write index " + tmp_path);
+    }
+
+    std::string buffer;
+    TrainingSample sample;
+    uint64_t offset = 0;
+    uint64_t records = 0;
+    int64_t game_id = -1;
+    while (true) {
+        int32_t size = 0;
+        if (!data.read(reinterpret_cast<char*>(&size), sizeof(size)) || size < 0) break;
+        buffer.resize(static_cast<size_t>(size));
+        if (!data.read(&buffer[0], size) || !sample.ParseFromString(buffer)) break;
+
+        if (startsGame(sample) || game_id < 0) game_id++;
+        SampleIndexEntry entry{};
+        entry.offset = offset;
+        entry.game_id = static_cast<uint32_t>(game_id);
+        entry.is_bidding = sample.is_bidding() ? 1 : 0;
+        if (std::fwrite(&entry, sizeof(entry), 1, index) != 1) {
+            std::fclose(index);
+            throw std::runtime_error("Could not write index " + tmp_path);
+        }
+        offset += sizeof(size) + static_cast<uint64_t>(size);
+        records++;
+    }
+    std::fclose(index);
+    std::filesystem::rename(tmp_path, pathFor(data_path));
+    if (indexed_bytes) *indexed_bytes = offset;
+    return records;
+}
+
+// --- SampleIndexAppender ---
+
+SampleIndexAppender::SampleIndexAppender(const std::string& data_path) {
+    std::string path = SampleIndex::pathFor(data_path);
+    std::error_code ec;
+    bool fresh = !std::filesystem::exists(path, ec) || std::filesystem::file_size(path, ec) == 0;
+    file = std::fopen(path.c_str(), "ab");
+    if (!file || (fresh && !writeHeader(file))) {
+        if (file) std::fclose(file);
+        throw std::runtime_error("Could not open index for writing: " + path);
+    }
+}
+
+SampleIndexAppender::~SampleIndexAppender() {
+    close();
+}
+
+bool SampleIndexAppender::append(const std::vector<SampleIndexEntry>& entries) {
+    return std::fwrite(entries.data(), sizeof(SampleIndexEntry), entries.size(), file) == entries.size();
+}
+
+bool SampleIndexAppender::close() {
+    if (!file) return true;
+    bool ok = std::fclose(file) == 0;
+    file = nullptr;
+    return ok;
+}
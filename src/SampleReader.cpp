@@ -0,0 +1,63 @@
+#include "include/SampleReader.hpp"
+#include <stdexcept>
+#include <string>
+
+SampleReader::SampleReader(const std::string& path) : path(path) {
+    if (CompactReader::isCompactFile(path)) {
+        compact = std::make_unique<CompactReader>(path);
+        return;
+    }
+    if (ChunkedReader::isChunkedFile(path)) {
+        chunked = std::make_unique<ChunkedReader>(path);
+        return;
+    }
+    proto.open(path, std::ios::binary);
+    if (!proto.is_open()) {
+        throw std::runtime_error("Could not open " + path);
+    }
+}
+
+bool SampleReader::nextSerialized(std::string& bytes) {
+    if (compact) {
+        if (!compact->next(scratch)) return false;
+        return scratch.SerializeToString(&bytes);
+    }
+    if (chunked) {
+        if (chunked->next(bytes)) return true;
+        const ChunkedReadStats& stats = chunked->stats();
+        if (stats.damaged_chunks > 0 || stats.skipped_bytes > 0) {
+            warning_message = path + ": skipped " + std::to_string(stats.damaged_chunks) + " damaged chunk(s), " +
+                std::to_string(stats.skipped_bytes) + " bytes in total.";
+        }
+        return false;
+    }
+    int32_t size = 0;
+    if (!proto.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+        return false; // End of file
+    }
+    if (size < 0) {
+        warning_message = path + " has an invalid record length, stopping here.";
+        return false;
+    }
+    bytes.resize(static_cast<size_t>(size));
+    if (!proto.read(&bytes[0], size)) {
+        warning_message = "Truncated message at end of " + path + ".";
+        return false;
+    }
+    return true;
+}
+
+bool SampleReader::next(TrainingSample& sample) {
+    if (compact) {
+        return compact->next(sample);
+    }
+    if (!nextSerialized(buffer)) {
+        return false;
+    }
+    if (!sample.ParseFromString(buffer)) {
+        // Older iterations used a raw float layout that is not Protobuf.
+        warning_message = path + " is not a size-delimited Protobuf file, skipping the rest of it.";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+#include "include/SuitIsomorphism.hpp"
+#include "include/FeatureEncoder.hpp"
+#include <algorithm>
+#include <cstdint>
+
+using FeatureEncoder::kPlayHandOffset;
+using FeatureEncoder::kPlayTrickOffset;
+
+bool SuitPermutation::isIdentity() const {
+    for (int s = 0; s < 4; ++s) {
+        if (static_cast<int>(to_canonical[s]) != s) return false;
+    }
+    return true;
+}
+
+// Side suits are ordered by descending key; ties are suits that look identical to
+// whoever built the key, so either order yields the same canonical form.
+template <typename Key>
+static SuitPermutation permutationFromKeys(const std::array<Key, 3>& keys) {
+    std::array<int, 3> order = { 0, 1, 2 };
+    std::stable_sort(order.begin(), order.end(), [&keys](int a, int b) { return keys[b] < keys[a]; });
+
+    SuitPermutation perm;
+    for (int canonical = 0; canonical < 3; ++canonical) {
+        Suit original = static_cast<Suit>(order[canonical]);
+        perm.to_canonical[order[canonical]] = static_cast<Suit>(canonical);
+        perm.from_canonical[canonical] = original;
+    }
+    return perm;
+}
+
+SuitPermutation SuitIsomorphism::canonicalFeaturePermutation(const std::vector<float>& nn2_features) {
+    using Key = std::array<uint16_t, 2>;
+    std::array<Key, 3> keys{};
+    for (int suit = 0; suit < 3; ++suit) {
+        for (int rank = 0; rank < 13; ++rank) {
+            if (nn2_features[kPlayHandOffset + suit * 13 + rank] != 0.0f) keys[suit][0] |= static_cast<uint16_t>(1u << rank);
+            if (nn2_features[kPlayTrickOffset + suit * 13 + rank] != 0.0f) keys[suit][1] |= static_cast<uint16_t>(1u << rank);
+        }
+    }
+    return permutationFromKeys(keys);
+}
+
+void SuitIsomorphism::permuteFeatures(std::vector<float>& nn2_features, const SuitPermutation& perm) {
+    if (perm.isIdentity()) return;
+    std::array<float, 104> original;
+    std::copy_n(nn2_features.begin() + kPlayHandOffset, original.size(), original.begin());
+    for (int canonical = 0; canonical < 4; ++canonical) {
+        int source = static_cast<int>(perm.from_canonical[canonical]);
+        std::copy_n(original.begin() + source * 13, 13, nn2_features.begin() + kPlayHandOffset + canonical * 13);
+        std::copy_n(original.begin() + 52 + source * 13, 13, nn2_features.begin() + kPlayTrickOffset + canonical * 13);
+    }
+}
+
+std::vector<float> SuitIsomorphism::policyToOriginal(const std::vector<float>& canonical_policy,
+                                                     const std::vector<Card>& original_hand, const SuitPermutation& perm) {
+    if (perm.isIdentity()) return canonical_policy;
+
+    std::vector<Card> canonical_hand;
+    canonical_hand.reserve(original_hand.size());
+    for (const Card& card : original_hand) canonical_hand.push_back(perm.apply(card));
+    std::vector<Card> sorted_hand = canonical_hand;
+    std::sort(sorted_hand.begin(), sorted_hand.end());
+
+    std::vector<float> policy = canonical_policy;
+    for (size_t i = 0; i < canonical_hand.size() && i < policy.size(); ++i) {
+        size_t canonical_idx = std::lower_bound(sorted_hand.begin(), sorted_hand.end(), canonical_hand[i]) - sorted_hand.begin();
+        policy[i] = canonical_idx < canonical_policy.size() ? canonical_policy[canonical_idx] : 0.0f;
+    }
+    return policy;
+}
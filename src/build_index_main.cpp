@@ -0,0 +1,52 @@
+#include "include/SampleIndex.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Builds the <file>.idx record index for size-delimited Protobuf data files written
+// before self-play maintained one (or whose index is stale). Up-to-date indexes are
+// left alone unless --force is given.
+
+int main(int argc, char* argv[]) {
+    bool force = false;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--force") {
+            force = true;
+        }
+        else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--force] <data.bin> [more files...]\n";
+        std::cerr << "Writes <data.bin>.idx: record offsets, is_bidding flags and game ids.\n";
+        return 1;
+    }
+
+    int failures = 0;
+    for (const std::string& path : inputs) {
+        try {
+            if (!force && SampleIndex::isCurrent(path)) {
+                std::cout << path << ": index is up to date." << std::endl;
+                continue;
+            }
+            uint64_t records = SampleIndex::rebuild(path);
+            std::vector<SampleIndexEntry> entries;
+            SampleIndex::load(path, entries);
+            uint64_t games = entries.empty() ? 0 : entries.back().game_id + 1;
+            std::cout << path << ": indexed " << records << " records in " << games << " games";
+            if (!SampleIndex::isCurrent(path)) {
+                std::cout << " (the file has a truncated or unreadable tail after the last indexed record)";
+            }
+            std::cout << "." << std::endl;
+        }
+        catch (const std::exception& e) {
+            std::cerr << path << ": " << e.what() << std::endl;
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+#include "include/ChunkedWriter.hpp"
+#include "include/ColumnarWriter.hpp"
+#include "include/CompactWriter.hpp"
+#include "include/SampleReader.hpp"
+#include "include/test.pb.h"
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Converts training files (size-delimited Protobuf, the default self-play output,
+// chunked or compact record files) into a columnar dataset directory that
+// train_mcts_bots_pytorch.py can memory-map, or into a compact or chunked dataset.
+// Samples are appended one game-sized batch at a time, so any file size works.
+
+static constexpr size_t kBatchSamples = 4096;
+
+static bool convertFile(const std::string& path, ISampleWriter& writer, uint64_t& converted) {
+    std::unique_ptr<SampleReader> reader;
+    try {
+        reader = std::make_unique<SampleReader>(path);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    std::vector<TrainingSample> batch(kBatchSamples);
+    size_t filled = 0;
+    while (reader->next(batch[filled])) {
+        if (++filled == kBatchSamples) {
+            writer.writeGame(batch);
+            converted += filled;
+            filled = 0;
+        }
+    }
+    if (!reader->warning().empty()) {
+        std::cerr << "Warning: " << reader->warning() << std::endl;
+    }
+    batch.resize(filled);
+    writer.writeGame(batch);
+    converted += filled;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int first_arg = 1;
+    std::string format = "columnar";
+    if (argc > 2 && std::string(argv[1]) == "--to") {
+        format = argv[2];
+        if (format != "columnar" && format != "compact" && format != "chunked") {
+            std::cerr << "Error: Unknown --to format '" << format << "'.\n";
+            return 1;
+        }
+        first_arg = 3;
+    }
+    if (argc < first_arg + 2) {
+        std::cerr << "Usage: " << argv[0] << " [--to columnar|compact|chunked] <output> <input> [more inputs...]\n";
+        std::cerr << "Appends every sample of the input files (.bin Protobuf streams, chunked or compact files) to the\n";
+        std::cerr << "columnar dataset directory (default), compact or chunked dataset file <output>.\n";
+        return 1;
+    }
+
+    std::string outputPath = argv[first_arg];
+    try {
+        std::unique_ptr<ColumnarWriter> columnar;
+        std::unique_ptr<CompactWriter> compact;
+        std::unique_ptr<ChunkedWriter> chunked;
+        ISampleWriter* writer = nullptr;
+        if (format == "compact") {
+            compact = std::make_unique<CompactWriter>(outputPath);
+            writer = compact.get();
+        }
+        else if (format == "chunked") {
+            chunked = std::make_unique<ChunkedWriter>(outputPath);
+            writer = chunked.get();
+        }
+        else {
+            columnar = std::make_unique<ColumnarWriter>(outputPath);
+            writer = columnar.get();
+        }
+        int failures = 0;
+        for (int i = first_arg + 1; i < argc; ++i) {
+            uint64_t converted = 0;
+            if (!convertFile(argv[i], *writer, converted)) {
+                failures++;
+            }
+            std::cout << argv[i] << ": " << converted << " samples" << std::endl;
+        }
+        writer->close();
+        uint64_t skipped = 0;
+        if (compact) {
+            std::cout << "Dataset " << outputPath << " now holds " << compact->records() << " records";
+            skipped = compact->skippedSamples();
+        }
+        else if (chunked) {
+            std::cout << "Appended " << chunked->records() << " samples to " << outputPath << " in " << chunked->chunks() << " chunks";
+        }
+        else {
+            std::cout << "Dataset " << outputPath << " now holds " << columnar->bidRows() << " bidding and "
+                << columnar->playRows() << " playing rows";
+            skipped = columnar->skippedSamples();
+        }
+        if (skipped > 0) {
+            std::cout << " (" << skipped << " samples with a different feature layout skipped)";
+        }
+        std::cout << "." << std::endl;
+        return failures == 0 ? 0 : 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "FATAL: " << e.what() << std::endl;
+        return 1;
+    }
+}
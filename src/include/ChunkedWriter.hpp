@@ -0,0 +1,103 @@
+#ifndef CHUNKEDWRITER_HPP
+#define CHUNKEDWRITER_HPP
+
+#include "ISampleWriter.hpp"
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Chunked container for size-delimited TrainingSample records. The file is a plain
+// sequence of fixed-size chunks, each with its own header:
+//   magic "SPDCHNK1", chunk_bytes, payload_bytes, record_count, payload CRC32C,
+//   reserved, header CRC32C (of the 28 bytes before it)
+// followed by payload_bytes of records (4-byte length + message) and zero padding up
+// to chunk_bytes. There is no file header: a chunk is written with a single append,
+// so several processes may append to one file, and a crash leaves at most one torn
+// chunk. Readers skip damaged chunks by scanning for the next valid header.
+struct ChunkHeader {
+    char magic[8];
+    uint32_t chunk_bytes;
+    uint32_t payload_bytes;
+    uint32_t record_count;
+    uint32_t payload_crc;
+    uint32_t reserved;
+    uint32_t header_crc;
+};
+static_assert(sizeof(ChunkHeader) == 32, "ChunkHeader layout is part of the file format");
+
+class ChunkedWriter : public ISampleWriter {
+public:
+    static constexpr uint32_t kDefaultChunkBytes = 256 * 1024;
+
+    // Appends to `path`. An existing file keeps the chunk size of its first chunk.
+    explicit ChunkedWriter(const std::string& path, uint32_t chunk_bytes = kDefaultChunkBytes);
+    ~ChunkedWriter() override;
+
+    ChunkedWriter(const ChunkedWriter&) = delete;
+    ChunkedWriter& operator=(const ChunkedWriter&) = delete;
+
+    void writeGame(const std::vector<TrainingSample>& samples) override;
+    // Writes the last, partly filled chunk. Idempotent.
+    void close() override;
+
+    uint64_t records() const { return record_count; }
+    uint64_t chunks() const { return chunk_count; }
+
+private:
+    void sealChunk(std::vector<char>& chunk, uint32_t payload_bytes, uint32_t records);
+    void appendChunk(const std::vector<char>& chunk);
+
+    std::string path;
+    uint32_t chunk_bytes;
+    int fd = -1;
+    std::mutex mutex;                  // Guards the chunk being filled and the counters
+    std::vector<char> current;
+    uint32_t current_used = 0;         // Payload bytes in `current`
+    uint32_t current_records = 0;
+    uint64_t record_count = 0;
+    uint64_t chunk_count = 0;
+    bool closed = false;
+};
+
+struct ChunkedReadStats {
+    uint64_t chunks = 0;
+    uint64_t records = 0;
+    uint64_t damaged_chunks = 0;  // Chunks with a valid header but a bad or missing payload
+    uint64_t skipped_bytes = 0;   // Bytes passed over while looking for the next valid header
+};
+
+// Reads the records of the chunks that start in [begin, end). Disjoint ranges of one
+// file can be read by different threads: every reader agrees on where chunks start.
+class ChunkedReader {
+public:
+    explicit ChunkedReader(const std::string& path, uint64_t begin = 0,
+                           uint64_t end = std::numeric_limits<uint64_t>::max());
+
+    // Serialized TrainingSample; false once no chunk of the range is left.
+    bool next(std::string& record);
+
+    const ChunkedReadStats& stats() const { return read_stats; }
+    uint64_t fileSize() const { return file_size; }
+
+    static bool isChunkedFile(const std::string& path);
+
+private:
+    bool loadChunk();
+    bool readHeaderAt(uint64_t offset, ChunkHeader& header);
+    uint64_t findHeader(uint64_t from);
+
+    std::string path;
+    std::ifstream in;
+    uint64_t file_size = 0;
+    uint64_t position;    // Where the next chunk starts
+    uint64_t end;
+    std::vector<char> chunk;
+    size_t cursor = 0;    // Next record within chunk
+    size_t payload_end = 0;
+    ChunkedReadStats read_stats;
+};
+
+#endif // CHUNKEDWRITER_HPP
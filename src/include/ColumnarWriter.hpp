@@ -0,0 +1,93 @@
+#ifndef COLUMNARWRITER_HPP
+#define COLUMNARWRITER_HPP
+
+#include "ISampleWriter.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One fixed-width column stored as a NumPy .npy file (format 1.0, little-endian,
+// C order). The header is a fixed 128 bytes and the row count is rewritten on
+// close, so the file can be appended to and numpy can memory-map it directly
+// with np.load(path, mmap_mode='r'). Reopened, the column holds the whole rows
+// found on disk, which after a crash may be more than its header says.
+class NpyColumn {
+public:
+    // descr is the NumPy dtype string, e.g. "<f4"; row_width 0 means a 1-D column.
+    NpyColumn(const std::string& path, const std::string& descr, size_t element_size, size_t row_width);
+    ~NpyColumn();
+
+    NpyColumn(const NpyColumn&) = delete;
+    NpyColumn& operator=(const NpyColumn&) = delete;
+
+    void appendRows(const void* data, size_t rows);
+    // Drops rows past `rows`, or appends zero rows up to it
+    void resize(uint64_t rows);
+    void close();
+    uint64_t rows() const { return row_count; }
+    bool isNew() const { return created; } // The file did not exist before
+
+private:
+    void writeHeader();
+    void seekToEnd();
+
+    std::string path;
+    std::string descr;
+    size_t row_width;
+    size_t row_bytes;
+    uint64_t row_count = 0;
+    bool created = false;
+    std::FILE* file = nullptr;
+};
+
+// Columnar alternative to the size-delimited Protobuf stream. A dataset is a
+// directory with one sub-directory per phase:
+//   bidding/  features (N, 8)   policy (N, 14)  value (N,)  outcome (N,)  player (N,)  generation (N,)  sampling_rate (N,)  fast_search (N,)
+//   playing/  features (N, 118) policy (N, 13)  value (N,)  outcome (N,)  player (N,)  generation (N,)  sampling_rate (N,)  fast_search (N,)
+// float32 throughout except player/generation (int32) and fast_search (uint8, 1 for
+// TrainingSample::fast_search). Playing policies are zero-padded to 13 entries.
+// sampling_rate is TrainingSample::sampling_rate, 0 where it was not recorded.
+// manifest.json records the format and FeatureEncoder versions.
+// Opening an existing dataset appends to it, after the last row every column holds.
+class ColumnarWriter : public ISampleWriter {
+public:
+    explicit ColumnarWriter(const std::string& directory);
+    ~ColumnarWriter() override;
+
+    void writeGame(const std::vector<TrainingSample>& samples) override;
+    void close() override;
+
+    uint64_t bidRows() const { return bidding.features.rows(); }
+    uint64_t playRows() const { return playing.features.rows(); }
+    uint64_t skippedSamples() const { return skipped; }
+
+private:
+    struct PhaseColumns {
+        PhaseColumns(const std::string& directory, size_t feature_width, size_t policy_width);
+        std::vector<NpyColumn*> all();
+        NpyColumn features;
+        NpyColumn policy;
+        NpyColumn value;
+        NpyColumn outcome;
+        NpyColumn player;
+        NpyColumn generation;
+        NpyColumn sampling_rate;
+        NpyColumn fast_search;
+        size_t feature_width;
+        size_t policy_width;
+    };
+
+    void appendSample(PhaseColumns& columns, const TrainingSample& sample);
+
+    std::string directory;
+    std::mutex mutex;
+    PhaseColumns bidding;
+    PhaseColumns playing;
+    uint64_t skipped = 0; // Samples whose widths do not match the current layout
+    bool closed = false;
+    std::vector<float> row; // Scratch row, guarded by mutex
+};
+
+#endif // COLUMNARWRITER_HPP
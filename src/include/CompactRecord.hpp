@@ -0,0 +1,62 @@
+#ifndef COMPACTRECORD_HPP
+#define COMPACTRECORD_HPP
+
+#include "test.pb.h"
+#include <cstdint>
+#include <vector>
+
+// Bit-packed form of one TrainingSample. Instead of the 118 float features the
+// record keeps the game state they are derived from: hand and current trick as
+// 52-bit card masks (bit = suit * 13 + rank, as in FeatureEncoder), scores and bags
+// as int16, bids and tricks won as bytes. Expansion back to the float layout
+// happens at load time (CompactRecord::decode here, load_training_data_compact in
+// train_mcts_bots_pytorch.py).
+struct CompactRecord {
+    uint64_t hand_mask;        // Cards of the player to move (playing samples only)
+    uint64_t trick_mask;       // Cards in the current trick (playing samples only)
+    float value_target;
+    float outcome;             // actual_game_win_value
+    int16_t scores[2];         // team1, team2
+    int16_t bags[2];
+    uint16_t model_generation;
+    int8_t bids[4];            // -1 = not yet bid
+    uint8_t tricks_won[4];
+    uint8_t flags;             // kCompactXxx bits below
+    uint8_t player_idx;
+    uint8_t current_player;    // Last playing feature; normally equal to player_idx
+    uint8_t policy_entries;    // Number of CompactPolicyEntry items belonging to this record
+    uint8_t feature_version;
+    uint8_t sampling_rate;     // round(-kCompactSamplingRateSteps * log2(rate)); 0 = every decision kept
+};
+static_assert(sizeof(CompactRecord) == 48, "CompactRecord layout is part of the file format");
+
+constexpr uint8_t kCompactBidding = 1 << 0;
+constexpr uint8_t kCompactSpadesBroken = 1 << 1;
+constexpr uint8_t kCompactVisitCounts = 1 << 2; // Policy counts are the exact root visit counts
+constexpr uint8_t kCompactFastSearch = 1 << 3;  // TrainingSample::fast_search
+
+// TrainingSample::sampling_rate is kept on a log scale, to within about 2%, down to
+// 2^-15.9; files written before it was recorded hold 0 there, which reads back as 1.
+constexpr float kCompactSamplingRateSteps = 16.0f; // Steps per halving
+
+// Sparse policy: only actions with a non-zero share are stored. The target is
+// count / sum(counts) over the record's entries.
+#pragma pack(push, 1)
+struct CompactPolicyEntry {
+    uint8_t action; // Bid (0-13) or hand index
+    uint16_t count;
+};
+#pragma pack(pop)
+static_assert(sizeof(CompactPolicyEntry) == 3, "CompactPolicyEntry layout is part of the file format");
+
+namespace CompactCodec {
+    // Packs `sample`, appending its policy entries to `policy`. Returns false (and
+    // leaves `policy` untouched) when the features are not in a layout this format
+    // can represent exactly, e.g. another feature width or non-integral values.
+    bool encode(const TrainingSample& sample, CompactRecord& record, std::vector<CompactPolicyEntry>& policy);
+
+    // Rebuilds the TrainingSample (FeatureEncoder layout) from a record and its entries.
+    void decode(const CompactRecord& record, const CompactPolicyEntry* entries, TrainingSample& sample);
+}
+
+#endif // COMPACTRECORD_HPP
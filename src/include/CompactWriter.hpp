@@ -0,0 +1,67 @@
+#ifndef COMPACTWRITER_HPP
+#define COMPACTWRITER_HPP
+
+#include "CompactRecord.hpp"
+#include "ISampleWriter.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Writes bit-packed CompactRecords, roughly a tenth of the size of the Protobuf
+// stream. A dataset is two files:
+//   <path>         16-byte header ("SPDCMP1\0", record size, feature version) + 48-byte records
+//   <path>.policy  3-byte CompactPolicyEntry items, record after record
+// Both are plain arrays, so numpy can memory-map them; record i's policy starts at
+// the running sum of policy_entries before it. Opening an existing dataset appends
+// to it, first trimming any partial tail left by an interrupted write.
+class CompactWriter : public ISampleWriter {
+public:
+    explicit CompactWriter(const std::string& path);
+    ~CompactWriter() override;
+
+    void writeGame(const std::vector<TrainingSample>& samples) override;
+    void close() override;
+
+    uint64_t records() const { return record_count; }
+    uint64_t bytesWritten() const { return bytes_written; }
+    uint64_t skippedSamples() const { return skipped; }
+
+    static std::string policyPath(const std::string& path) { return path + ".policy"; }
+
+private:
+    void openForAppend();
+
+    std::string path;
+    std::mutex mutex;
+    std::FILE* record_file = nullptr;
+    std::FILE* policy_file = nullptr;
+    uint64_t record_count = 0;
+    uint64_t bytes_written = 0; // This session, both files
+    uint64_t skipped = 0;       // Samples CompactCodec::encode could not represent
+    bool closed = false;
+    std::vector<CompactRecord> records_scratch;   // Guarded by mutex
+    std::vector<CompactPolicyEntry> policy_scratch;
+};
+
+// Reads a compact dataset back; used by tools that expand it in C++.
+class CompactReader {
+public:
+    explicit CompactReader(const std::string& path);
+    ~CompactReader();
+
+    CompactReader(const CompactReader&) = delete;
+    CompactReader& operator=(const CompactReader&) = delete;
+
+    // Decodes the next record into `sample`; false at the end of the dataset.
+    bool next(TrainingSample& sample);
+
+    static bool isCompactFile(const std::string& path);
+
+private:
+    std::FILE* record_file = nullptr;
+    std::FILE* policy_file = nullptr;
+};
+
+#endif // COMPACTWRITER_HPP
@@ -0,0 +1,12 @@
+#ifndef CRC32C_HPP
+#define CRC32C_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32C (Castagnoli), the checksum used by the chunked data format. Uses the SSE4.2
+// crc32 instruction when the build targets it, slicing-by-8 tables otherwise.
+// Pass the previous result as `crc` to checksum data in pieces.
+uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+#endif // CRC32C_HPP
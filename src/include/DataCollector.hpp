@@ -3,27 +3,69 @@
 
 #include "GameState.hpp"
 #include "MCTSBot.hpp"
+#include "ISampleWriter.hpp"
 #include "test.pb.h" // Include the generated Protobuf header
-#include <fstream>
+#include <cstdint>
+#include <memory>
+#include <random>
 #include <vector>
 #include <string>
 
+// Which decisions of a game become training samples. The stages apply in order;
+// a kept sample's sampling_rate is the probability that it survived all of them
+// (given how many decisions its round and game had), so trainers can reweight.
+struct SamplingPolicy {
+    double keep_probability = 1.0; // Each decision is kept with this probability
+    int max_per_round = 0;         // Uniform subset of at most this many per round (0 = no cap)
+    int max_per_game = 0;          // Reservoir of at most this many per game (0 = no cap)
+    bool record_fast_searches = false; // Keep decisions from reduced playout-cap searches too
+};
+
 class DataCollector {
 public:
     DataCollector(const std::string& filepath);
-    ~DataCollector();
+    // Buffers this collector's games and hands them to a writer shared with other collectors
+    DataCollector(std::shared_ptr<ISampleWriter> writer, const SamplingPolicy& sampling = SamplingPolicy());
 
-    void record(const GameState& state, MCTSBot& bot, bool isBidding);
+    // fastSearch: the bot searched with the reduced playout-cap budget (see SamplingPolicy)
+    void record(const GameState& state, MCTSBot& bot, bool isBidding, bool fastSearch = false);
+    // Same as record, from an already known search result (used when replaying game records)
+    void recordDecision(const GameState& state, bool isBidding, const std::vector<float>& policy, int visit_total,
+                        float value_target, int model_generation, bool fastSearch = false);
     void finalize(int winning_team_id);
+    // Drops the current game's buffered samples without writing them
+    void discard();
+
+    uint64_t decisionsSeen() const { return decisions_seen; }   // record/recordDecision calls so far
+    uint64_t samplesWritten() const { return samples_written; }
 
 private:
-    // The buffer now holds the type-safe Protobuf message objects
-    std::vector<TrainingSample> game_buffer;
-    std::ofstream file;
+    struct PendingSample {
+        uint64_t sequence; // Decision number within the game, to write kept samples in game order
+        float rate;
+        TrainingSample sample;
+    };
+
+    void closeRound();
+    void offerToGame(PendingSample&& pending);
+
+    std::shared_ptr<ISampleWriter> writer;
+    SamplingPolicy sampling;
+    std::mt19937 rng;
+
+    // Current round's kept decisions (a reservoir when max_per_round is set), then the game's
+    std::vector<PendingSample> round_buffer;
+    uint64_t round_seen = 0;      // Decisions of this round that passed keep_probability
+    std::vector<PendingSample> game_buffer;
+    uint64_t game_offered = 0;    // Round survivors offered to the game reservoir
+    uint64_t game_sequence = 0;
+
+    uint64_t decisions_seen = 0;
+    uint64_t samples_written = 0;
 
-    // Feature extraction helpers remain the same
-    std::vector<float> extractBidFeatures(const GameState& state);
-    std::vector<float> extractPlayFeatures(const GameState& state);
+    // Scratch row for FeatureEncoder, reused across records
+    std::vector<float> feature_row;
+    std::vector<TrainingSample> output;
 };
 
-#endif // DATACOLLECTOR_HPP
\ No newline at end of file
+#endif // DATACOLLECTOR_HPP
@@ -0,0 +1,100 @@
+#ifndef DATAWRITER_HPP
+#define DATAWRITER_HPP
+
+#include "BoundedQueue.hpp"
+#include "ISampleWriter.hpp"
+#include "SampleIndex.hpp"
+#include "test.pb.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct DataWriterOptions {
+    size_t queue_capacity = 256;          // Finished games in flight before producers stall
+    size_t block_bytes = 4 * 1024 * 1024; // Staging block size; the file is written in blocks this large
+    size_t sync_every_bytes = 0;          // fdatasync after this many bytes (0 = leave it to the OS)
+    bool write_index = true;              // Maintain the <file>.idx record index alongside the data
+};
+
+struct DataWriterStats {
+    uint64_t games = 0;
+    uint64_t bytes_written = 0;
+    uint64_t blocks_written = 0;
+    uint64_t syncs = 0;
+    uint64_t producer_stalls = 0;  // writeGame calls that found the queue full
+    double producer_stall_ms = 0;  // Total time producers spent waiting for space
+    size_t max_queue_depth = 0;
+};
+
+// Appends finished games to one size-delimited Protobuf file (4-byte length prefix
+// per TrainingSample). Shared by every DataCollector of a self-play run: each game
+// is serialized on the calling thread and handed to a background writer through a
+// bounded lock-free queue. The writer packs games into large aligned blocks, so game
+// threads never touch the disk and games from different workers never interleave.
+class DataWriter : public ISampleWriter {
+public:
+    explicit DataWriter(const std::string& filepath, const DataWriterOptions& options = DataWriterOptions());
+    ~DataWriter() override;
+
+    DataWriter(const DataWriter&) = delete;
+    DataWriter& operator=(const DataWriter&) = delete;
+
+    // Blocks only while the queue is full. Throws if the writer thread has failed.
+    void writeGame(const std::vector<TrainingSample>& samples) override;
+
+    // Drains the queue, writes the last partial block and syncs. Idempotent.
+    void close() override;
+
+    DataWriterStats stats() const;
+
+private:
+    void writerLoop();
+    void flushBlock();
+    void flushIndex();
+    void syncFile();
+    void fail(const std::string& message);
+
+    std::string path;
+    DataWriterOptions options;
+    std::FILE* file = nullptr;
+
+    // One serialized game plus what the index needs to know about its records
+    struct PendingGame {
+        std::string bytes;
+        std::vector<uint8_t> is_bidding;
+    };
+    BoundedQueue<PendingGame> queue;
+
+    // Index state, only touched by the writer thread. Entries are written once the
+    // block holding their records has been written, so the index never runs ahead.
+    std::unique_ptr<SampleIndexAppender> index;
+    std::vector<SampleIndexEntry> pending_index;
+    uint64_t data_offset = 0;
+    uint32_t next_game_id = 0;
+
+    // Staging block, only touched by the writer thread
+    char* block = nullptr;
+    size_t block_used = 0;
+    size_t bytes_since_sync = 0;
+
+    std::atomic<bool> stop_requested{false};
+    std::atomic<bool> failed{false};
+    std::mutex error_mutex;
+    std::string error_message;
+    std::once_flag close_once;
+    std::thread writer_thread;
+
+    std::atomic<uint64_t> games{0};
+    std::atomic<uint64_t> bytes_written{0};
+    std::atomic<uint64_t> blocks_written{0};
+    std::atomic<uint64_t> syncs{0};
+    std::atomic<uint64_t> producer_stalls{0};
+    std::atomic<uint64_t> producer_stall_ns{0};
+    std::atomic<size_t> max_queue_depth{0};
+};
+
+#endif // DATAWRITER_HPP
@@ -0,0 +1,90 @@
+#ifndef DOUBLEDUMMY_HPP
+#define DOUBLEDUMMY_HPP
+
+#include "GameState.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Double-dummy trick solver: with every hand known, the tricks each team takes from a
+// position when both sides play perfectly, for any number of remaining tricks.
+//
+// Hands are 52-bit card masks (bit = suit * 13 + rank). The search is alpha-beta run
+// as a series of null-window "can team 0 take n more tricks?" probes. Cards that no
+// play can tell apart are searched once (see GameLogic::getDistinctMoves), likely
+// winners and cheap discards are tried first, and bounds are kept in a transposition
+// table at trick boundaries. Entries use relative ranks (which hand holds the first,
+// second, ... highest card still out in each suit), and each one keeps only the cards
+// down to the lowest that won a trick by rank in its search: below those, only
+// how many cards of the suit each hand holds matters, so one entry answers for every
+// position that differs just in the owners of low cards. Table entries stay valid
+// from one deal to the next, so a solver can be reused; it is not thread-safe.
+//
+// The objective is tricks, not score: bids, nils and bags play no part.
+class DoubleDummySolver {
+public:
+    static constexpr size_t kDefaultTableEntries = size_t{1} << 19;
+
+    // The table is emptied whenever it reaches max_entries
+    explicit DoubleDummySolver(size_t max_entries = kDefaultTableEntries);
+
+    // Tricks team 0 (players 0 and 2) and team 1 still take from `state`, counting the
+    // trick in progress. Before a trick starts, state.currentPlayerIndex leads it; to
+    // value a fresh deal during bidding, set it to the opening leader first.
+    std::array<int, 2> solve(const GameState& state);
+
+    // Tricks the team to move takes from here on (the trick in progress included) after
+    // each card of the mover's hand, indexed like the hand; -1 for cards that may not
+    // be played now.
+    std::vector<int> solveMoves(const GameState& state);
+
+    uint64_t nodes() const { return node_count; }
+    void clear(); // Forgets the transposition table
+
+private:
+    struct Position {
+        std::array<uint64_t, 4> hands;
+        uint64_t trick_mask = 0;        // Cards of the trick in progress
+        std::array<int, 4> trick_cards; // In play order, trick_size of them
+        int trick_size = 0;
+        int leader = 0;
+        int player = 0;
+        bool broken = false;
+    };
+    struct Key {
+        uint64_t shape;                 // Cards per hand and suit (4 bits each), leader, spades broken
+        std::array<uint32_t, 4> owners; // Per suit, two bits per card still out from the highest
+    };
+    struct Entry {
+        std::array<uint32_t, 4> kept;   // Per suit, the owner bits of the cards that matter
+        std::array<uint32_t, 4> owners; // Those owner bits, the rest zero
+        int8_t lower; // Bounds on the tricks the leader's team takes from the boundary
+        int8_t upper;
+        uint8_t lead; // Lead that refuted the probe: suit * 16 + cards out above it, 0xFF if none
+    };
+
+    static Position fromState(const GameState& state);
+    static uint64_t legalMoves(const Position& pos);
+    static void play(Position& pos, int card);
+    static int remainingTricks(const Position& pos);
+    static void sureTricks(const Position& pos, int& team0, int& team1, uint64_t& relevant);
+    int orderedMoves(const Position& pos, int* moves) const;
+    static Key makeKey(const Position& pos);
+    static bool matches(const Entry& entry, const Key& key);
+    void store(const Key& key, uint64_t relevant_cards, uint64_t all, int lower, int upper, int lead);
+
+    // Does team 0 take >= target of the tricks left? `relevant` receives the cards
+    // whose rank decided a trick in the search; lower cards did not matter.
+    bool search(const Position& pos, int target, uint64_t& relevant);
+    int tricksForTeam0(const Position& pos);
+
+    // Entries by shape: all positions an entry answers for share it
+    std::unordered_map<uint64_t, std::vector<Entry>> table;
+    size_t entry_count = 0;
+    size_t max_entries;
+    uint64_t node_count = 0;
+};
+
+#endif // DOUBLEDUMMY_HPP
@@ -0,0 +1,45 @@
+#ifndef FEATUREENCODER_HPP
+#define FEATUREENCODER_HPP
+
+#include "GameState.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Single source of truth for the network input layouts, used by both the search
+// (MCTSBot) and data collection (DataCollector). Encoders write straight into a
+// caller-supplied row, so a batch is just a contiguous rows x kXxxFeatureCount
+// matrix. Bump kFeatureVersion whenever a layout changes; it is stored with every
+// training sample.
+namespace FeatureEncoder {
+    constexpr int kFeatureVersion = 1;
+
+    // NN1 (bidding): scores, bags, bids so far (-1 = not yet bid)
+    constexpr size_t kBidFeatureCount = 8;
+
+    // NN2 / policy+value (playing)
+    constexpr size_t kPlayHandOffset = 8;                    // After scores, bags, 4 bids
+    constexpr size_t kPlayTrickOffset = kPlayHandOffset + 52; // 52-card multi-hot blocks, suit * 13 + rank
+    constexpr size_t kPlayTricksWonOffset = kPlayTrickOffset + 52;
+    constexpr size_t kPlayFeatureCount = kPlayTricksWonOffset + 4 + 2; // + spades broken, current player
+
+    // NN3 (value): total points, point difference, own bags, other bags
+    constexpr size_t kValueFeatureCount = 4;
+
+    inline int cardIndex(const Card& card) { return static_cast<int>(card.suit) * 13 + static_cast<int>(card.rank); }
+    uint64_t cardMask(const std::vector<Card>& cards);
+
+    // Writes bit i of the 52-bit mask as 0.0f / 1.0f into out[i].
+    void expandCardMask(uint64_t mask, float* out);
+
+    void encodeBid(const GameState& state, float* row);
+    void encodePlay(const GameState& state, float* row);
+    void encodeValue(const GameState& state, int perspective_player_idx, float* row);
+
+    // Resize `row` (a no-op once it has the right size) and encode into it.
+    void encodeBid(const GameState& state, std::vector<float>& row);
+    void encodePlay(const GameState& state, std::vector<float>& row);
+    void encodeValue(const GameState& state, int perspective_player_idx, std::vector<float>& row);
+}
+
+#endif // FEATUREENCODER_HPP
@@ -5,12 +5,20 @@
 #include "SpadesTypes.hpp"
 #include <vector>
 #include <array> // For std::array
+#include <random>
 
 namespace GameLogic {
     void initializeDeck(std::vector<Card>& deck);
     void shuffleDeck(std::vector<Card>& deck);
+    void shuffleDeck(std::vector<Card>& deck, std::mt19937& rng); // Caller-owned stream, e.g. one per self-play worker
     void dealCards(GameState& state);
     std::vector<int> getValidMoves(const GameState& state);
+    // Valid moves with equivalent cards collapsed: two cards of a suit in the hand are
+    // equivalent when every card ranked between them is in the same hand or gone in a
+    // finished trick, since then no play can tell them apart. Returns the lowest card
+    // of each class. `representative`, if given, maps every hand index to the hand
+    // index standing for its class (-1 for cards that may not be played now).
+    std::vector<int> getDistinctMoves(const GameState& state, std::vector<int>* representative = nullptr);
     int determineTrickWinner(const GameState& state);
     void updateScores(GameState& state, int& team1RoundPoints, int& team2RoundPoints); // Note: teamXRoundPoints are OUT parameters
     bool isGameOver(const GameState& state);
@@ -23,6 +31,15 @@ namespace GameLogic {
 
     // Helper for TRAM - will be called by MCTS too
     bool canTram(const GameState& state); 
+
+    // Claims: fills `tricks` with the tricks each player takes from here to the end of
+    // the round when no choice of play can change them any more. That is the case when
+    // the player on lead holds nothing but winners (drawing the other spades first if
+    // need be), when the side on lead holds every winner and the opponents are out of
+    // spades, or when every remaining card play is forced. Works on card bitmasks, so
+    // it is cheap enough to ask before every card.
+    bool findClaim(const GameState& state, std::array<int, 4>& tricks);
+    void applyClaim(GameState& state, const std::array<int, 4>& tricks); // Credits the tricks and ends the round
 }
 
 #endif // GAMELOGIC_HPP
\ No newline at end of file
@@ -0,0 +1,94 @@
+#ifndef GAMERECORD_HPP
+#define GAMERECORD_HPP
+
+#include "DataCollector.hpp"
+#include "GameState.hpp"
+#include "MCTSBot.hpp"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Replayable log of one self-play game: the deals, every bid and card played, and
+// the root search result behind each decision (visit counts, value estimate, model
+// generation). Unlike training samples it holds no features, so a new feature
+// layout only needs a replay (replay_records) instead of new searches.
+//
+// A game is a byte string of events, all integers little-endian:
+//   Round  tag=1, dealer u8, 4 x u64 hand masks (bit = suit * 13 + rank)
+//   Bid    tag=2, player u8, bid u8,        generation u16, value f32, n u8, n x (action u8, visits varint)
+//   Play   tag=3, player u8, card index u8, generation u16, value f32, n u8, n x (hand index u8, visits varint)
+//   Claim  tag=4, player u8, tricks u8      (the player claimed the remaining tricks)
+//   End    tag=5, winning team u8
+//   FastBid tag=6, FastPlay tag=7: as Bid and Play, from a reduced playout-cap search
+//   Resign tag=8, team u8                   (the team conceded; End names the other team)
+//   SplitClaim tag=9, 4 x tricks u8         (a claim crediting several players, e.g. forced play)
+// Only actions with visits are listed; a decision without any is the search's
+// uniform fallback over the legal actions.
+class GameRecorder {
+public:
+    void beginGame();
+    void beginRound(int dealer, const GameState& dealt_state);
+    void recordBid(int player, int bid, const MCTSBot& bot, bool fastSearch = false);
+    void recordPlay(int player, const Card& card, const MCTSBot& bot, bool fastSearch = false);
+    void recordClaim(const std::array<int, 4>& tricks); // As returned by GameLogic::findClaim
+    void recordResign(int team);
+    void endGame(int winning_team_id);
+
+    const std::string& bytes() const { return buffer; }
+
+private:
+    void recordSearch(const MCTSBot& bot);
+
+    std::string buffer;
+};
+
+// Appends games to a record file: an 8-byte magic ("SPDGAME1"), then each game as a
+// u32 length and its event bytes. Thread-safe; one writer serves every self-play worker.
+// Reopening a file drops a truncated last game before appending.
+class GameRecordWriter {
+public:
+    explicit GameRecordWriter(const std::string& path);
+    ~GameRecordWriter();
+
+    GameRecordWriter(const GameRecordWriter&) = delete;
+    GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+
+    void writeGame(const std::string& game);
+    void close();
+
+    uint64_t games() const { return game_count; }
+
+private:
+    std::string path;
+    std::mutex mutex;
+    std::FILE* file = nullptr;
+    uint64_t game_count = 0;
+};
+
+// Sequential reader; a truncated last game (interrupted write) ends the file.
+class GameRecordReader {
+public:
+    explicit GameRecordReader(const std::string& path);
+    ~GameRecordReader();
+
+    GameRecordReader(const GameRecordReader&) = delete;
+    GameRecordReader& operator=(const GameRecordReader&) = delete;
+
+    bool next(std::string& game);
+
+private:
+    std::FILE* file = nullptr;
+};
+
+namespace GameReplay {
+    // Replays one recorded game through GameLogic and hands every decision to
+    // `collector` (features from the current FeatureEncoder), finalizing the game.
+    // Returns false with `error` set if the record is malformed or no longer
+    // consistent with the game rules; nothing is collected for that game.
+    bool replay(const std::string& game, DataCollector& collector, std::string& error);
+}
+
+#endif // GAMERECORD_HPP
@@ -0,0 +1,38 @@
+#ifndef ISAMPLEWRITER_HPP
+#define ISAMPLEWRITER_HPP
+
+#include "test.pb.h"
+#include <memory>
+#include <vector>
+
+// Destination for finished games of training samples. Implementations must accept
+// writeGame calls from several self-play workers at once.
+class ISampleWriter {
+public:
+    virtual ~ISampleWriter() = default;
+    virtual void writeGame(const std::vector<TrainingSample>& samples) = 0;
+    // Flushes everything written so far; no writeGame calls may follow.
+    virtual void close() = 0;
+};
+
+// Hands every game to several writers, e.g. the output file and the replay buffer.
+class SampleWriterFanOut : public ISampleWriter {
+public:
+    explicit SampleWriterFanOut(std::vector<std::shared_ptr<ISampleWriter>> writers) : writers(std::move(writers)) {}
+
+    void writeGame(const std::vector<TrainingSample>& samples) override {
+        for (auto& writer : writers) {
+            writer->writeGame(samples);
+        }
+    }
+    void close() override {
+        for (auto& writer : writers) {
+            writer->close();
+        }
+    }
+
+private:
+    std::vector<std::shared_ptr<ISampleWriter>> writers;
+};
+
+#endif // ISAMPLEWRITER_HPP
@@ -0,0 +1,71 @@
+#ifndef INFERENCECACHE_HPP
+#define INFERENCECACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct InferenceCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+
+    double hitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+};
+
+// Thread-safe memo of model outputs keyed by a hash of the exact input bytes (and
+// shape). Entries are spread over independently locked shards, each an LRU list
+// with its share of the byte budget, so concurrent searches rarely contend. The
+// full input is kept with every entry, so a hash collision is a miss, never a
+// wrong answer.
+class InferenceCache {
+public:
+    InferenceCache(size_t max_bytes, size_t shard_count = 16);
+
+    // Copies the cached outputs into `outputs` and returns true on a hit.
+    bool lookup(const std::vector<float>& input, const std::vector<int64_t>& shape,
+                std::vector<std::vector<float>>& outputs);
+    void insert(const std::vector<float>& input, const std::vector<int64_t>& shape,
+                const std::vector<std::vector<float>>& outputs);
+
+    InferenceCacheStats stats() const;
+    void clear();
+
+private:
+    struct Entry {
+        uint64_t hash;
+        std::vector<float> input;
+        std::vector<int64_t> shape;
+        std::vector<std::vector<float>> outputs;
+        size_t bytes;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru; // Most recently used first
+        std::unordered_multimap<uint64_t, std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+    };
+
+    static uint64_t hashInput(const std::vector<float>& input, const std::vector<int64_t>& shape);
+    static size_t entryBytes(const Entry& entry);
+    Shard& shardFor(uint64_t hash) { return *shards[(hash >> 32) % shards.size()]; }
+
+    size_t shard_max_bytes;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+};
+
+#endif // INFERENCECACHE_HPP
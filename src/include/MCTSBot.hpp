@@ -2,8 +2,11 @@
 #define MCTSBOT_HPP
 
 #include "Bot.hpp"
+#include "DoubleDummy.hpp"
 #include "GameState.hpp"
 #include "ONNXModel.hpp"
+#include "ModelLoader.hpp"
+#include "PolicyValueModel.hpp"
 #include <memory>
 #include <random>
 #include <vector> // Required for std::vector<int64_t>
@@ -11,6 +14,25 @@
 // Forward declaration
 class MCTSNode;
 
+// Per-decision search budgets. simulationsPerMove becomes the average budget: easy
+// decisions spend less and bank the rest, which later funds decisions with more
+// options to tell apart. Disabled, every search spends exactly simulationsPerMove.
+struct SearchBudgetOptions {
+    bool enabled = false;
+    int min_simulations = 8;          // Floor for any decision that is searched
+    double max_scale = 3.0;           // Ceiling, as a multiple of simulationsPerMove
+    double reference_branching = 6.0; // Branching factor that is worth exactly simulationsPerMove
+    double max_carry = 4.0;           // Banked simulations are capped at this many simulationsPerMove
+    int exact_solve_tricks = 3;       // Solve the card play exactly once this few tricks remain (0 = never)
+};
+
+// How the last decision was made
+enum class SearchKind {
+    Searched, // MCTS with getLastSimulations() simulations
+    Forced,   // Only one distinct legal move (see GameLogic::getDistinctMoves), no search
+    Solved,   // Exact endgame solve; every optimal move counts one visit
+};
+
 class MCTSBot : public IBot {
 public:
     MCTSBot(int simulations_per_move,
@@ -19,26 +41,77 @@ public:
             std::shared_ptr<ONNXModel> nn3  // Win Prediction
     );
 
+    // Fused variant: one policy+value network evaluates playing leaves in a single
+    // call. NN1/NN3 are still used for bidding searches when provided.
+    MCTSBot(int simulations_per_move,
+            std::shared_ptr<ONNXModel> nn1,          // Bidding
+            std::shared_ptr<PolicyValueModel> pv,    // Playing policy + value
+            std::shared_ptr<ONNXModel> nn3 = nullptr // Win Prediction (bidding rollouts)
+    );
+
     int getBid(const Player& player, const GameState& state) override;
     int getMove(const GameState& state, const std::vector<int>& validMoves) override;
 
     // Public for DataCollector to access
     std::vector<float> getLastActionProbs() const { return lastActionProbs; }
     std::vector<float> getLastValueEstimate() const { return lastValueEstimate; }
+    // Root visit counts behind getLastActionProbs (all zero when the search fell back to uniform)
+    const std::vector<int>& getLastVisitCounts() const { return lastVisitCounts; }
+
+    // Swap in a hot-reloaded model set between decisions. The fused path is used
+    // whenever the new set carries a policy+value model.
+    void updateModels(const ModelSet& models);
+    int getModelGeneration() const { return modelGeneration; }
+
+    // Evaluate playing positions in their suit-canonical form (see SuitIsomorphism),
+    // so isomorphic positions share inference-cache entries.
+    void setSuitCanonicalization(bool enabled) { canonicalizeSuits = enabled; }
 
+    // Search budget of the next getBid/getMove; self-play varies it per decision (playout cap).
+    void setSimulationsPerMove(int simulations) { simulationsPerMove = simulations; }
+    int getSimulationsPerMove() const { return simulationsPerMove; }
+
+    // Schedule the budget of each decision instead (see SearchBudgetOptions). Resets the bank.
+    void setSearchBudget(const SearchBudgetOptions& options) { budgetOptions = options; carriedSimulations = 0; }
+    SearchKind getLastSearchKind() const { return lastSearchKind; }
+    int getLastSimulations() const { return lastSimulations; }
+
+    // Finish rollouts by double-dummy solving (see DoubleDummySolver) once this few
+    // tricks remain, instead of random play (0 = never). Rounds with a nil still at
+    // risk are played out: the solver counts tricks, not who takes them.
+    void setDoubleDummyRollouts(int tricks);
 
 private:
     int simulationsPerMove;
     std::shared_ptr<ONNXModel> nn1_model;
     std::shared_ptr<ONNXModel> nn2_model;
     std::shared_ptr<ONNXModel> nn3_model;
+    std::shared_ptr<PolicyValueModel> pv_model;
+    int modelGeneration = 0;
+    bool canonicalizeSuits = false;
     std::mt19937 rng;
+    SearchBudgetOptions budgetOptions;
+    int carriedSimulations = 0;       // Budget banked by cheaper decisions
+    int ddRolloutTricks = 0;
+    std::unique_ptr<DoubleDummySolver> ddSolver; // Kept across searches: its table stays valid
+    SearchKind lastSearchKind = SearchKind::Searched;
+    int lastSimulations = 0;
 
     std::vector<float> lastActionProbs;   // Policy output from root MCTS search
     std::vector<float> lastValueEstimate; // Value output from root MCTS search (for NN3)
+    std::vector<int> lastVisitCounts;     // Root child visits per action, same indexing as lastActionProbs
+
+    // Reused network input rows (see FeatureEncoder); sized once, then rewritten in place.
+    std::vector<float> bid_row;
+    std::vector<float> play_row;
+    std::vector<float> value_row;
 
 
     std::unique_ptr<MCTSNode> runMCTS(const GameState& rootState, bool isBidding);
+    PolicyValueOutput evaluatePlaying(const GameState& state);
+    int scheduleSimulations(double branching, double phase);
+    void bankSimulations(int unused);
+    void solveEndgame(const GameState& state);
 };
 
 #endif // MCTSBOT_HPP
\ No newline at end of file
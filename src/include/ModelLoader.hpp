@@ -0,0 +1,37 @@
+#ifndef MODELLOADER_HPP
+#define MODELLOADER_HPP
+
+#include "ONNXModel.hpp"
+#include "PolicyValueModel.hpp"
+#include <memory>
+#include <string>
+
+// The networks a self-play process runs with. Missing optional models are null.
+struct ModelSet {
+    std::shared_ptr<ONNXModel> nn1;        // Bidding policy (optional)
+    std::shared_ptr<ONNXModel> nn2;        // Playing policy (optional, unused with pv)
+    std::shared_ptr<ONNXModel> nn3;        // Win prediction (required)
+    std::shared_ptr<PolicyValueModel> pv;  // Fused playing policy + value (--fused)
+    int generation = 0;                    // Bumped by ModelWatcher on every hot reload
+};
+
+struct ModelLoadOptions {
+    bool prefer_quantized = false;  // Use nnX_model.int8.onnx when present
+    bool fused = false;             // Load pv_model.onnx in place of NN2
+    bool use_optimized_cache = true; // Reuse/write serialized optimized graphs
+    bool warmup = true;             // Run a dummy batch through each model after loading
+    size_t inference_cache_bytes = 0; // Per-model inference result cache (0 = disabled)
+};
+
+// Resolves nnX_model.onnx inside the model directory. With preferQuantized, the int8
+// model written by quantize_models.py (nnX_model.int8.onnx) is used when it exists.
+std::string resolveModelPath(const std::string& modelPath, const std::string& name, bool preferQuantized);
+
+// Loads all models from modelPath concurrently and reports per-model and total
+// startup time. Throws std::runtime_error if a required model is missing.
+ModelSet loadModelSet(const std::string& modelPath, const ModelLoadOptions& options);
+
+// Prints hit rate and memory use of each model's inference cache, if enabled.
+void reportCacheStats(const ModelSet& models);
+
+#endif // MODELLOADER_HPP
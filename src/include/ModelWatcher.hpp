@@ -0,0 +1,51 @@
+#ifndef MODELWATCHER_HPP
+#define MODELWATCHER_HPP
+
+#include "ModelLoader.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Watches the model directory and hot-reloads the ModelSet in the background when
+// the trainer publishes new nnX_model.onnx files. Readers take the current set with
+// current() between decisions; the swap is an atomic shared_ptr store, so sessions
+// of the previous generation stay alive until the last bot holding them lets go.
+class ModelWatcher {
+public:
+    ModelWatcher(const std::string& modelPath, const ModelLoadOptions& options, ModelSet initial,
+                 std::chrono::milliseconds pollInterval);
+    ~ModelWatcher();
+
+    ModelWatcher(const ModelWatcher&) = delete;
+    ModelWatcher& operator=(const ModelWatcher&) = delete;
+
+    std::shared_ptr<const ModelSet> current() const;
+
+private:
+    // Last write time and size of every model file the loader would pick up.
+    using Fingerprint = std::map<std::string, std::pair<std::filesystem::file_time_type, std::uintmax_t>>;
+
+    Fingerprint scan() const;
+    void watchLoop();
+
+    std::string model_path;
+    ModelLoadOptions load_options;
+    std::chrono::milliseconds poll_interval;
+
+    std::shared_ptr<const ModelSet> models; // Accessed only through std::atomic_load/atomic_store
+    Fingerprint loaded_fingerprint;
+
+    std::mutex stop_mutex;
+    std::condition_variable stop_cv;
+    bool stop_requested = false;
+    std::thread watcher_thread;
+};
+
+#endif // MODELWATCHER_HPP
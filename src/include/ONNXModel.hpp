@@ -5,16 +5,64 @@
 #include <vector>
 #include <memory>
 #include <onnxruntime_cxx_api.h>
+#include "InferenceCache.hpp"
+
+// Process-wide ONNX Runtime settings shared by every ONNXModel.
+struct ONNXSessionConfig {
+    // Thread counts; 0 lets ORT pick (one thread per physical core).
+    int intra_op_threads = 0;
+    int inter_op_threads = 0;
+    // One global pool in the shared Ort::Env instead of a pool per session.
+    bool use_global_thread_pool = true;
+
+    GraphOptimizationLevel graph_optimization_level = ORT_ENABLE_ALL;
+    ExecutionMode execution_mode = ORT_SEQUENTIAL;
+
+    // Memory arena: enable/disable the CPU arena, and optionally share a single
+    // env-registered arena across sessions (0 max bytes = unlimited).
+    bool enable_cpu_mem_arena = true;
+    bool enable_mem_pattern = true;
+    bool share_arena_across_sessions = false;
+    size_t arena_max_bytes = 0;
+    int arena_extend_strategy = 0; // 0 = next power of two, 1 = same as requested
+};
 
 class ONNXModel {
 public:
-    ONNXModel(const std::string& model_path);
+    // Must be called before the first ONNXModel is constructed; the shared
+    // environment (and its thread pool) is created once and lives for the process.
+    static void configureRuntime(const ONNXSessionConfig& config);
+
+    // With use_optimized_cache, the ORT-optimized graph is serialized next to the
+    // model (<model>.opt-<session options>.ort) on first load and reused while it is
+    // newer than the .onnx, so later processes skip graph optimization at startup.
+    ONNXModel(const std::string& model_path, bool use_optimized_cache = false);
+
+    // Run one dummy batch (zeros, dynamic dims set to 1) so first-inference
+    // allocations and kernel selection happen before the first real decision.
+    void warmup();
+
+    bool loadedFromCache() const { return loaded_from_cache; }
 
     // Run inference and return the output tensor values
     std::vector<float> predict(const std::vector<float>& input_data, const std::vector<int64_t>& input_shape);
 
+    // Run inference and return every output tensor, in the model's output order
+    std::vector<std::vector<float>> predictAll(const std::vector<float>& input_data, const std::vector<int64_t>& input_shape);
+
+    size_t outputCount() const { return output_node_names.size(); }
+
+    // Memoize predict/predictAll results for repeated inputs, bounded to max_bytes.
+    // Safe to share across threads; bots sharing this model share the cache too.
+    void enableCache(size_t max_bytes);
+    const InferenceCache* cache() const { return inference_cache.get(); }
+
 private:
-    Ort::Env env;
+    static Ort::Env& sharedEnv();
+    static Ort::SessionOptions makeSessionOptions();
+    static std::string optimizedCachePath(const std::string& model_path);
+
+    bool loaded_from_cache = false;
     Ort::Session session;
 
     // Keep owned std::string copies so c_str() pointers remain valid.
@@ -24,6 +72,10 @@ private:
     // Pointers required by ORT API (point into the std::string data above)
     std::vector<const char*> input_node_names;
     std::vector<const char*> output_node_names;
+
+    std::unique_ptr<InferenceCache> inference_cache;
+
+    std::vector<std::vector<float>> runSession(const std::vector<float>& input_data, const std::vector<int64_t>& input_shape);
 };
 
 #endif // ONNXMODEL_HPP
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef PIMCBOT_HPP
+#define PIMCBOT_HPP
+
+#include "DoubleDummy.hpp"
+#include "GameState.hpp"
+#include "IBot.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct PIMCOptions {
+    int samples = 32;  // Deals solved per decision
+    int threads = 0;   // Solver threads, 0 = one per core
+    uint32_t seed = 0; // 0 = seeded from std::random_device
+};
+
+// Perfect-information Monte Carlo: for each decision, deal the cards the bot cannot
+// see at random, consistent with the hand sizes and with the suits players have been
+// seen to fail to follow, solve every deal double-dummy (see DoubleDummySolver) and
+// take the option that does best on average.
+//
+// Cards are compared by the round margin they lead to: each deal's trick counts are
+// scored with the bids made, as GameLogic::updateScores would. Bids come from the
+// same kind of table: the team's tricks over sampled deals decide the contract worth
+// the most, of which the first of the partners to bid claims its share by high cards.
+// Nil is never bid, and a nil still at risk is assumed to hold, since the solver only
+// counts each team's tricks.
+//
+// Deals are solved on a pool of worker threads, each with a solver of its own whose
+// table is kept from one decision to the next. Several seats may share one bot: what
+// it remembers about voids is public. Not thread-safe.
+class PIMCBot : public IBot {
+public:
+    explicit PIMCBot(const PIMCOptions& options = PIMCOptions());
+    ~PIMCBot() override;
+    PIMCBot(const PIMCBot&) = delete;
+    PIMCBot& operator=(const PIMCBot&) = delete;
+
+    int getBid(const Player& player, const GameState& state) override;
+    int getMove(const GameState& state, const std::vector<int>& validMoves) override;
+
+    int threads() const { return static_cast<int>(solvers.size()); }
+    uint64_t samplesSolved() const { return samples_solved; }
+    double samplesPerSecond() const { return solve_seconds > 0.0 ? samples_solved / solve_seconds : 0.0; }
+
+private:
+    // Hands for the other three players, drawn from the cards `observer` cannot see
+    GameState sampleDeal(const GameState& state, int observer, std::mt19937& rng) const;
+    void observe(const GameState& state);
+    // Runs task(worker, sample) for every sample index, spread over the pool
+    void runSamples(int count, const std::function<void(int, int)>& task);
+    void workerLoop(int worker);
+    void runTasks(int worker);
+
+    PIMCOptions options;
+    std::array<uint8_t, 4> void_suits{}; // Per player, a bit per suit it cannot hold
+    int cards_out = 0;                   // Cards in hands at the last decision; more means a new deal
+    std::vector<std::mt19937> rngs;      // One per worker
+    std::vector<std::unique_ptr<DoubleDummySolver>> solvers;
+    uint64_t samples_solved = 0;
+    double solve_seconds = 0.0;
+
+    // The pool: the calling thread is worker 0, the others wait for a new generation
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+    const std::function<void(int, int)>* task = nullptr;
+    int task_count = 0;
+    std::atomic<int> next_task{0};
+    uint64_t generation = 0;
+    int busy_workers = 0;
+    bool stopping = false;
+    std::exception_ptr failure;
+};
+
+#endif // PIMCBOT_HPP
@@ -0,0 +1,33 @@
+#ifndef POLICYVALUEMODEL_HPP
+#define POLICYVALUEMODEL_HPP
+
+#include "ONNXModel.hpp"
+#include <string>
+#include <vector>
+
+// Output of one fused evaluation: card policy over hand indices plus the win
+// probability for the team of the player to move.
+struct PolicyValueOutput {
+    std::vector<float> policy;
+    float value = 0.5f;
+};
+
+// Two-headed playing network (shared trunk, policy head + value head) exported by
+// train_mcts_bots_pytorch.py --fused as pv_model.onnx. Takes the NN2 feature vector
+// and replaces a separate NN2 + NN3 call pair with a single inference.
+class PolicyValueModel {
+public:
+    PolicyValueModel(const std::string& model_path, bool use_optimized_cache = false);
+
+    PolicyValueOutput evaluate(const std::vector<float>& features);
+
+    void warmup() { model.warmup(); }
+    bool loadedFromCache() const { return model.loadedFromCache(); }
+    void enableCache(size_t max_bytes) { model.enableCache(max_bytes); }
+    const InferenceCache* cache() const { return model.cache(); }
+
+private:
+    ONNXModel model;
+};
+
+#endif // POLICYVALUEMODEL_HPP
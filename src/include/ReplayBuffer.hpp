@@ -0,0 +1,72 @@
+#ifndef REPLAYBUFFER_HPP
+#define REPLAYBUFFER_HPP
+
+#include "CompactRecord.hpp"
+#include "ISampleWriter.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+enum class ReplaySampling {
+    Uniform, // Every stored sample equally likely
+    Recency, // Weight halves every recency_half_life inserts of age
+};
+
+struct ReplayBufferOptions {
+    size_t capacity = 1 << 20;        // Samples kept across all shards; the oldest are overwritten
+    size_t shards = 8;                // One per self-play worker keeps inserts uncontended
+    double recency_half_life = 0;     // In samples; 0 = capacity / 4
+};
+
+// Fixed-capacity in-memory ring of training samples in CompactRecord form, fed by
+// self-play (it is an ISampleWriter) and sampled into minibatches concurrently.
+// Each writer thread is bound to its own shard, so inserts take no lock that any
+// other writer or reader waits on; every slot carries a sequence number (seqlock)
+// and readers simply retry a slot that is being overwritten. Slot contents are
+// copied through relaxed atomic words, so a torn read is discarded, not a data race.
+class ReplayBuffer : public ISampleWriter {
+public:
+    explicit ReplayBuffer(const ReplayBufferOptions& options = ReplayBufferOptions());
+
+    void writeGame(const std::vector<TrainingSample>& samples) override;
+    void close() override {} // Samples stay available to readers
+
+    // Draws `count` samples (with replacement) and appends them in the compact file
+    // layout: records, plus their policy entries in record order. Returns the number
+    // drawn, 0 while the buffer is empty.
+    size_t sample(size_t count, ReplaySampling mode, std::mt19937_64& rng,
+                  std::vector<CompactRecord>& records, std::vector<CompactPolicyEntry>& policy) const;
+
+    uint64_t inserted() const;   // Total samples ever inserted
+    size_t size() const;         // Samples currently held
+    size_t capacity() const { return shard_capacity * shards.size(); }
+    uint64_t skippedSamples() const { return skipped.load(std::memory_order_relaxed); }
+
+private:
+    // Record followed by its policy entries, rounded up to whole words
+    static constexpr size_t kSlotWords = (sizeof(CompactRecord) + 14 * sizeof(CompactPolicyEntry) + 7) / 8;
+    struct Slot {
+        std::atomic<uint32_t> sequence{0}; // Odd while being written
+        std::atomic<uint64_t> position{0}; // Insert position the payload belongs to
+        std::atomic<uint64_t> words[kSlotWords] = {};
+    };
+    struct Shard {
+        std::unique_ptr<Slot[]> slots;
+        std::atomic<uint64_t> head{0};          // Inserts so far; next slot is head % capacity
+        std::atomic<bool> writing{false};       // Guards against two writers sharing a shard
+    };
+
+    size_t shardForThisThread() const;
+    void insert(Shard& shard, const CompactRecord& record, const CompactPolicyEntry* entries);
+    bool readSlot(const Shard& shard, uint64_t position, CompactRecord& record, CompactPolicyEntry* entries) const;
+
+    size_t shard_capacity;
+    double recency_half_life;
+    std::vector<std::unique_ptr<Shard>> shards;
+    mutable std::atomic<size_t> next_shard{0};
+    std::atomic<uint64_t> skipped{0};
+};
+
+#endif // REPLAYBUFFER_HPP
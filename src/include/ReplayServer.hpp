@@ -0,0 +1,51 @@
+#ifndef REPLAYSERVER_HPP
+#define REPLAYSERVER_HPP
+
+#include "ReplayBuffer.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Serves ReplayBuffer minibatches over TCP (loopback by default) so the trainer can
+// pull fresh samples without a disk round-trip. One thread per connection; a
+// connection may send any number of requests. All integers little-endian.
+//   Request   "RBQ1", count u32, mode u8 (0 uniform, 1 recency), 3 reserved bytes
+//   Response  count u32, policy entries u32, total inserted u64,
+//             count x CompactRecord (48 bytes), entries x CompactPolicyEntry (3 bytes)
+// count 0 asks for the header only (buffer statistics). count is capped at kMaxBatch.
+class ReplayServer {
+public:
+    static constexpr uint32_t kMaxBatch = 1 << 16;
+
+    ReplayServer(const ReplayBuffer& buffer, uint16_t port, const std::string& bind_address = "127.0.0.1");
+    ~ReplayServer();
+
+    ReplayServer(const ReplayServer&) = delete;
+    ReplayServer& operator=(const ReplayServer&) = delete;
+
+    // Stops accepting, disconnects clients and joins all threads. Idempotent.
+    void stop();
+
+    uint64_t batchesServed() const { return batches_served.load(); }
+
+private:
+    using Socket = intptr_t; // SOCKET on Windows, file descriptor elsewhere
+
+    void acceptLoop();
+    void serveClient(Socket client);
+
+    const ReplayBuffer& buffer;
+    Socket listener = -1;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> batches_served{0};
+    std::thread accept_thread;
+    std::mutex clients_mutex;
+    std::vector<Socket> clients;
+    std::vector<std::thread> client_threads;
+    std::vector<std::thread::id> finished_clients; // Threads in client_threads that are done, to be joined
+};
+
+#endif // REPLAYSERVER_HPP
@@ -0,0 +1,54 @@
+#ifndef SAMPLEINDEX_HPP
+#define SAMPLEINDEX_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Sidecar index of a size-delimited Protobuf data file (<file>.idx): a 16-byte
+// header ("SPDIDX1\0", entry size) followed by one entry per record, in file order.
+// With it, readers can seek to any record, split a file across loader workers at
+// game boundaries, or sample records without scanning the whole file.
+struct SampleIndexEntry {
+    uint64_t offset;     // Of the record's 4-byte length prefix
+    uint32_t game_id;    // Consecutive within the file, starting at 0
+    uint8_t is_bidding;
+    uint8_t reserved[3];
+};
+static_assert(sizeof(SampleIndexEntry) == 16, "SampleIndexEntry layout is part of the file format");
+
+namespace SampleIndex {
+    std::string pathFor(const std::string& data_path);
+
+    // True if the index exists and covers exactly the whole records of the data file;
+    // `last` receives its final entry (untouched when the data file is empty).
+    bool isCurrent(const std::string& data_path, SampleIndexEntry* last = nullptr);
+
+    // Reads the index of `data_path`; false if it is missing or malformed.
+    bool load(const std::string& data_path, std::vector<SampleIndexEntry>& entries);
+
+    // Scans the data file and rewrites its index. Game ids come from game starts
+    // (a bidding sample with zero scores and no bids yet), since older files carry no
+    // game boundaries. Stops at the first truncated or unparsable record. Returns
+    // the number of records indexed; `indexed_bytes` receives where the last ends.
+    uint64_t rebuild(const std::string& data_path, uint64_t* indexed_bytes = nullptr);
+}
+
+// Appends entries to an index file as the matching records reach the data file.
+class SampleIndexAppender {
+public:
+    explicit SampleIndexAppender(const std::string& data_path);
+    ~SampleIndexAppender();
+
+    SampleIndexAppender(const SampleIndexAppender&) = delete;
+    SampleIndexAppender& operator=(const SampleIndexAppender&) = delete;
+
+    bool append(const std::vector<SampleIndexEntry>& entries);
+    bool close();
+
+private:
+    std::FILE* file = nullptr;
+};
+
+#endif // SAMPLEINDEX_HPP
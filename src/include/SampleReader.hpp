@@ -0,0 +1,38 @@
+#ifndef SAMPLEREADER_HPP
+#define SAMPLEREADER_HPP
+
+#include "ChunkedWriter.hpp"
+#include "CompactWriter.hpp"
+#include "test.pb.h"
+#include <fstream>
+#include <memory>
+#include <string>
+
+// Sequential reader for any training data file: size-delimited Protobuf streams
+// (.bin), chunked files and compact record files are told apart by their header.
+class SampleReader {
+public:
+    explicit SampleReader(const std::string& path);
+
+    // False at the end of the data, or where the rest of the file cannot be read
+    // (then warning() says why).
+    bool next(TrainingSample& sample);
+
+    // Serialized form of the next sample, without parsing it when the file is Protobuf.
+    bool nextSerialized(std::string& bytes);
+
+    bool isCompact() const { return compact != nullptr; }
+    bool isChunked() const { return chunked != nullptr; }
+    const std::string& warning() const { return warning_message; }
+
+private:
+    std::string path;
+    std::unique_ptr<CompactReader> compact;
+    std::unique_ptr<ChunkedReader> chunked;
+    std::ifstream proto;
+    std::string buffer;
+    TrainingSample scratch;
+    std::string warning_message;
+};
+
+#endif // SAMPLEREADER_HPP
@@ -0,0 +1,31 @@
+#ifndef SUITISOMORPHISM_HPP
+#define SUITISOMORPHISM_HPP
+
+#include "SpadesTypes.hpp"
+#include <array>
+#include <vector>
+
+// Clubs, diamonds and hearts are interchangeable under the rules (only spades is
+// trump), so up to 3! = 6 positions share one canonical form in which the side
+// suits are sorted into a fixed order. Spades always maps to itself.
+struct SuitPermutation {
+    std::array<Suit, 4> to_canonical = { Suit::CLUBS, Suit::DIAMONDS, Suit::HEARTS, Suit::SPADES };   // Indexed by original suit
+    std::array<Suit, 4> from_canonical = { Suit::CLUBS, Suit::DIAMONDS, Suit::HEARTS, Suit::SPADES }; // Indexed by canonical suit
+
+    bool isIdentity() const;
+    Card apply(const Card& card) const { return { to_canonical[static_cast<int>(card.suit)], card.rank }; }
+};
+
+namespace SuitIsomorphism {
+    // Canonical order using only what an NN2 feature vector sees (the mover's hand
+    // and the cards in the trick), so equal canonical features mean equal inputs.
+    SuitPermutation canonicalFeaturePermutation(const std::vector<float>& nn2_features);
+    void permuteFeatures(std::vector<float>& nn2_features, const SuitPermutation& perm);
+
+    // A playing policy is indexed by position in the (sorted) hand. Maps a policy
+    // over the canonical hand back onto the original hand's indices.
+    std::vector<float> policyToOriginal(const std::vector<float>& canonical_policy,
+                                        const std::vector<Card>& original_hand, const SuitPermutation& perm);
+}
+
+#endif // SUITISOMORPHISM_HPP
@@ -213,10 +213,15 @@ class TrainingSample final : public ::google::protobuf::Message
   enum : int {
     kStateFeaturesFieldNumber = 3,
     kPolicyTargetFieldNumber = 4,
-    kIsBiddingFieldNumber = 1,
     kPlayerIdxFieldNumber = 2,
     kValueTargetFieldNumber = 5,
     kActualGameWinValueFieldNumber = 6,
+    kIsBiddingFieldNumber = 1,
+    kFastSearchFieldNumber = 11,
+    kModelGenerationFieldNumber = 7,
+    kFeatureVersionFieldNumber = 8,
+    kVisitTotalFieldNumber = 9,
+    kSamplingRateFieldNumber = 10,
   };
   // repeated float state_features = 3;
   int state_features_size() const;
@@ -253,16 +258,6 @@ class TrainingSample final : public ::google::protobuf::Message
   const ::google::protobuf::RepeatedField<float>& _internal_policy_target() const;
   ::google::protobuf::RepeatedField<float>* _internal_mutable_policy_target();
 
-  public:
-  // bool is_bidding = 1;
-  void clear_is_bidding() ;
-  bool is_bidding() const;
-  void set_is_bidding(bool value);
-
-  private:
-  bool _internal_is_bidding() const;
-  void _internal_set_is_bidding(bool value);
-
   public:
   // int32 player_idx = 2;
   void clear_player_idx() ;
@@ -293,13 +288,73 @@ class TrainingSample final : public ::google::protobuf::Message
   float _internal_actual_game_win_value() const;
   void _internal_set_actual_game_win_value(float value);
 
+  public:
+  // bool is_bidding = 1;
+  void clear_is_bidding() ;
+  bool is_bidding() const;
+  void set_is_bidding(bool value);
+
+  private:
+  bool _internal_is_bidding() const;
+  void _internal_set_is_bidding(bool value);
+
+  public:
+  // bool fast_search = 11;
+  void clear_fast_search() ;
+  bool fast_search() const;
+  void set_fast_search(bool value);
+
+  private:
+  bool _internal_fast_search() const;
+  void _internal_set_fast_search(bool value);
+
+  public:
+  // int32 model_generation = 7;
+  void clear_model_generation() ;
+  ::int32_t model_generation() const;
+  void set_model_generation(::int32_t value);
+
+  private:
+  ::int32_t _internal_model_generation() const;
+  void _internal_set_model_generation(::int32_t value);
+
+  public:
+  // int32 feature_version = 8;
+  void clear_feature_version() ;
+  ::int32_t feature_version() const;
+  void set_feature_version(::int32_t value);
+
+  private:
+  ::int32_t _internal_feature_version() const;
+  void _internal_set_feature_version(::int32_t value);
+
+  public:
+  // int32 visit_total = 9;
+  void clear_visit_total() ;
+  ::int32_t visit_total() const;
+  void set_visit_total(::int32_t value);
+
+  private:
+  ::int32_t _internal_visit_total() const;
+  void _internal_set_visit_total(::int32_t value);
+
+  public:
+  // float sampling_rate = 10;
+  void clear_sampling_rate() ;
+  float sampling_rate() const;
+  void set_sampling_rate(float value);
+
+  private:
+  float _internal_sampling_rate() const;
+  void _internal_set_sampling_rate(float value);
+
   public:
   // @@protoc_insertion_point(class_scope:TrainingSample)
  private:
   class _Internal;
   friend class ::google::protobuf::internal::TcParser;
   static const ::google::protobuf::internal::TcParseTable<
-      3, 6, 0,
+      4, 11, 0,
       0, 2>
       _table_;
 
@@ -319,10 +374,15 @@ class TrainingSample final : public ::google::protobuf::Message
                           const TrainingSample& from_msg);
     ::google::protobuf::RepeatedField<float> state_features_;
     ::google::protobuf::RepeatedField<float> policy_target_;
-    bool is_bidding_;
     ::int32_t player_idx_;
     float value_target_;
     float actual_game_win_value_;
+    bool is_bidding_;
+    bool fast_search_;
+    ::int32_t model_generation_;
+    ::int32_t feature_version_;
+    ::int32_t visit_total_;
+    float sampling_rate_;
     ::google::protobuf::internal::CachedSize _cached_size_;
     PROTOBUF_TSAN_DECLARE_MEMBER
   };
@@ -524,6 +584,116 @@ inline void TrainingSample::_internal_set_actual_game_win_value(float value) {
   _impl_.actual_game_win_value_ = value;
 }
 
+// int32 model_generation = 7;
+inline void TrainingSample::clear_model_generation() {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.model_generation_ = 0;
+}
+inline ::int32_t TrainingSample::model_generation() const {
+  // @@protoc_insertion_point(field_get:TrainingSample.model_generation)
+  return _internal_model_generation();
+}
+inline void TrainingSample::set_model_generation(::int32_t value) {
+  _internal_set_model_generation(value);
+  // @@protoc_insertion_point(field_set:TrainingSample.model_generation)
+}
+inline ::int32_t TrainingSample::_internal_model_generation() const {
+  ::google::protobuf::internal::TSanRead(&_impl_);
+  return _impl_.model_generation_;
+}
+inline void TrainingSample::_internal_set_model_generation(::int32_t value) {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.model_generation_ = value;
+}
+
+// int32 feature_version = 8;
+inline void TrainingSample::clear_feature_version() {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.feature_version_ = 0;
+}
+inline ::int32_t TrainingSample::feature_version() const {
+  // @@protoc_insertion_point(field_get:TrainingSample.feature_version)
+  return _internal_feature_version();
+}
+inline void TrainingSample::set_feature_version(::int32_t value) {
+  _internal_set_feature_version(value);
+  // @@protoc_insertion_point(field_set:TrainingSample.feature_version)
+}
+inline ::int32_t TrainingSample::_internal_feature_version() const {
+  ::google::protobuf::internal::TSanRead(&_impl_);
+  return _impl_.feature_version_;
+}
+inline void TrainingSample::_internal_set_feature_version(::int32_t value) {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.feature_version_ = value;
+}
+
+// int32 visit_total = 9;
+inline void TrainingSample::clear_visit_total() {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.visit_total_ = 0;
+}
+inline ::int32_t TrainingSample::visit_total() const {
+  // @@protoc_insertion_point(field_get:TrainingSample.visit_total)
+  return _internal_visit_total();
+}
+inline void TrainingSample::set_visit_total(::int32_t value) {
+  _internal_set_visit_total(value);
+  // @@protoc_insertion_point(field_set:TrainingSample.visit_total)
+}
+inline ::int32_t TrainingSample::_internal_visit_total() const {
+  ::google::protobuf::internal::TSanRead(&_impl_);
+  return _impl_.visit_total_;
+}
+inline void TrainingSample::_internal_set_visit_total(::int32_t value) {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.visit_total_ = value;
+}
+
+// float sampling_rate = 10;
+inline void TrainingSample::clear_sampling_rate() {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.sampling_rate_ = 0;
+}
+inline float TrainingSample::sampling_rate() const {
+  // @@protoc_insertion_point(field_get:TrainingSample.sampling_rate)
+  return _internal_sampling_rate();
+}
+inline void TrainingSample::set_sampling_rate(float value) {
+  _internal_set_sampling_rate(value);
+  // @@protoc_insertion_point(field_set:TrainingSample.sampling_rate)
+}
+inline float TrainingSample::_internal_sampling_rate() const {
+  ::google::protobuf::internal::TSanRead(&_impl_);
+  return _impl_.sampling_rate_;
+}
+inline void TrainingSample::_internal_set_sampling_rate(float value) {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.sampling_rate_ = value;
+}
+
+// bool fast_search = 11;
+inline void TrainingSample::clear_fast_search() {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.fast_search_ = false;
+}
+inline bool TrainingSample::fast_search() const {
+  // @@protoc_insertion_point(field_get:TrainingSample.fast_search)
+  return _internal_fast_search();
+}
+inline void TrainingSample::set_fast_search(bool value) {
+  _internal_set_fast_search(value);
+  // @@protoc_insertion_point(field_set:TrainingSample.fast_search)
+}
+inline bool TrainingSample::_internal_fast_search() const {
+  ::google::protobuf::internal::TSanRead(&_impl_);
+  return _impl_.fast_search_;
+}
+inline void TrainingSample::_internal_set_fast_search(bool value) {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.fast_search_ = value;
+}
+
 #ifdef __GNUC__
 #pragma GCC diagnostic pop
 #endif  // __GNUC__
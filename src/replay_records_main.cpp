@@ -0,0 +1,155 @@
+#include "include/GameRecord.hpp"
+#include "include/DataCollector.hpp"
+#include "include/DataWriter.hpp"
+#include "include/ColumnarWriter.hpp"
+#include "include/ChunkedWriter.hpp"
+#include "include/CompactWriter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Regenerates training samples from game records (self_play --game-record-path)
+// without running any search: each game is replayed through GameLogic and every
+// decision is encoded with the FeatureEncoder this tool was built with. After a
+// feature change, bump FeatureEncoder::kFeatureVersion, rebuild and replay.
+
+// Hands out games from the input files in order to any number of replay threads.
+class GameSource {
+public:
+    explicit GameSource(std::vector<std::string> paths) : paths(std::move(paths)) {}
+
+    bool next(std::string& game) {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (true) {
+            if (reader && reader->next(game)) {
+                return true;
+            }
+            reader.reset();
+            if (next_path >= paths.size()) {
+                return false;
+            }
+            try {
+                reader = std::make_unique<GameRecordReader>(paths[next_path]);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Warning: " << e.what() << ", skipping it." << std::endl;
+            }
+            next_path++;
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::string> paths;
+    size_t next_path = 0;
+    std::unique_ptr<GameRecordReader> reader;
+};
+
+int main(int argc, char* argv[]) {
+    std::string outputPath;
+    std::string format = "proto";
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    SamplingPolicy sampling;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--output-data-path" && i + 1 < argc) {
+            outputPath = argv[++i];
+        }
+        else if (arg == "--output-format" && i + 1 < argc) {
+            format = argv[++i];
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--record-fast-searches") {
+            sampling.record_fast_searches = true;
+        }
+        else if (arg == "--sample-rate" && i + 1 < argc) {
+            sampling.keep_probability = std::clamp(std::stod(argv[++i]), 0.0, 1.0);
+        }
+        else if (arg == "--max-samples-per-round" && i + 1 < argc) {
+            sampling.max_per_round = std::max(0, std::stoi(argv[++i]));
+        }
+        else if (arg == "--max-samples-per-game" && i + 1 < argc) {
+            sampling.max_per_game = std::max(0, std::stoi(argv[++i]));
+        }
+        else {
+            inputs.push_back(arg);
+        }
+    }
+    if (outputPath.empty() || inputs.empty() || (format != "proto" && format != "columnar" && format != "compact" && format != "chunked")) {
+        std::cerr << "Usage: " << argv[0] << " --output-data-path <path> [--output-format proto|columnar|compact|chunked] [--threads <n>] <records> [more records...]\n";
+        std::cerr << "Replays game records and appends the re-encoded training samples to <path>.\n";
+        std::cerr << "  --sample-rate <p>, --max-samples-per-round <n>, --max-samples-per-game <n> : Subsample decisions as self_play does.\n";
+        std::cerr << "  --record-fast-searches : Also emit decisions made with a reduced playout-cap search.\n";
+        return 1;
+    }
+
+    try {
+        std::shared_ptr<ISampleWriter> writer;
+        if (format == "columnar") {
+            writer = std::make_shared<ColumnarWriter>(outputPath);
+        }
+        else if (format == "compact") {
+            writer = std::make_shared<CompactWriter>(outputPath);
+        }
+        else if (format == "chunked") {
+            writer = std::make_shared<ChunkedWriter>(outputPath);
+        }
+        else {
+            writer = std::make_shared<DataWriter>(outputPath);
+        }
+
+        GameSource source(inputs);
+        std::atomic<long long> replayed{0};
+        std::atomic<long long> failed{0};
+        std::mutex console_mutex;
+        auto start = std::chrono::steady_clock::now();
+
+        auto worker = [&]() {
+            DataCollector collector(writer, sampling);
+            std::string game;
+            std::string error;
+            while (source.next(game)) {
+                if (GameReplay::replay(game, collector, error)) {
+                    replayed++;
+                }
+                else if (failed++ < 10) {
+                    std::lock_guard<std::mutex> lock(console_mutex);
+                    std::cerr << "Warning: skipped a game record: " << error << std::endl;
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; ++t) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : pool) {
+            t.join();
+        }
+        writer->close();
+
+        double elapsed_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Replayed " << replayed.load() << " games in " << elapsed_sec << " s ("
+            << replayed.load() / std::max(elapsed_sec, 1e-9) << " games/s on " << threads << " thread(s))";
+        if (failed.load() > 0) {
+            std::cout << ", " << failed.load() << " records skipped";
+        }
+        std::cout << ". Samples written to " << outputPath << std::endl;
+        return failed.load() == 0 ? 0 : 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "FATAL: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,131 @@
+#include "include/FeatureEncoder.hpp"
+#include "include/GameLogic.hpp"
+#include "include/MCTSBot.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Checks that a fast (playout-cap) bidding search can still reach and return the
+// high bids. Without models, every bid must be searched; with NN1 (--input-model-path),
+// the bids searched must be the ones NN1 favours most, and positions where NN1 wants
+// to bid high must get a high bid. Exits non-zero on failure.
+
+static constexpr int kFastSimulations = 10; // self_play's default --fast-simulations
+
+// A fresh round with bidding about to open at seat 0, at a random point of the game
+// (NN1 sees the scores and bags, not the cards). With `all_spades`, seat 0 holds every
+// spade; the other cards are dealt at random.
+static GameState openBidding(std::mt19937& rng, bool all_spades) {
+    GameState state;
+    GameLogic::resetForNewRound(state, 3);
+    std::uniform_int_distribution<int> score(-200, 450), bags(0, 9);
+    state.team1Bags = bags(rng);
+    state.team2Bags = bags(rng);
+    state.team1Score = score(rng) / 10 * 10 + state.team1Bags;
+    state.team2Score = score(rng) / 10 * 10 + state.team2Bags;
+    GameLogic::initializeDeck(state.deck);
+    if (!all_spades) {
+        GameLogic::shuffleDeck(state.deck, rng);
+        GameLogic::dealCards(state);
+        return state;
+    }
+    std::vector<Card> rest;
+    for (const Card& card : state.deck) {
+        (card.suit == Suit::SPADES ? state.players[0].hand : rest).push_back(card);
+    }
+    std::shuffle(rest.begin(), rest.end(), rng);
+    for (size_t i = 0; i < rest.size(); ++i) {
+        state.players[1 + i % 3].hand.push_back(rest[i]);
+    }
+    for (auto& player : state.players) {
+        std::sort(player.hand.begin(), player.hand.end());
+    }
+    return state;
+}
+
+static int checkWithoutModels(std::mt19937& rng) {
+    MCTSBot bot(kFastSimulations, nullptr, std::shared_ptr<ONNXModel>(), nullptr);
+    GameState state = openBidding(rng, true);
+    bot.getBid(state.players[0], state);
+    const auto& visits = bot.getLastVisitCounts();
+    bool high_bids_searched = std::all_of(visits.begin() + 10, visits.end(), [](int v) { return v > 0; });
+    if (bot.getLastSimulations() < 14 || !high_bids_searched) {
+        std::cerr << "FAIL: without NN1, a fast bidding search ran " << bot.getLastSimulations()
+                  << " simulations and left bids 10-13 unsearched." << std::endl;
+        return 1;
+    }
+    std::cout << "Without models: all 14 bids searched in " << bot.getLastSimulations() << " simulations." << std::endl;
+    return 0;
+}
+
+static int checkWithNN1(const std::string& model_dir, std::mt19937& rng) {
+    auto nn1 = std::make_shared<ONNXModel>(model_dir + "/nn1_model.onnx");
+    MCTSBot bot(kFastSimulations, nn1, std::shared_ptr<ONNXModel>(), nullptr);
+    std::vector<float> row;
+    int favoured_high = 0, returned_high = 0;
+    for (int deal = 0; deal < 200; ++deal) {
+        GameState state = openBidding(rng, deal == 0);
+        FeatureEncoder::encodeBid(state, row);
+        std::vector<float> prior = nn1->predict(row, { 1, static_cast<int64_t>(FeatureEncoder::kBidFeatureCount) });
+        int bid = bot.getBid(state.players[0], state);
+        const auto& visits = bot.getLastVisitCounts();
+
+        // Every searched bid must be at least as likely under NN1 as every unsearched one
+        float least_searched = 1.0f, most_skipped = 0.0f;
+        for (int b = 0; b < 14; ++b) {
+            float p = b < static_cast<int>(prior.size()) ? prior[b] : 0.0f;
+            if (visits[b] > 0) least_searched = std::min(least_searched, p);
+            else most_skipped = std::max(most_skipped, p);
+        }
+        if (most_skipped > least_searched) {
+            std::cerr << "FAIL: deal " << deal << " searched a bid with prior " << least_searched
+                      << " but skipped one with prior " << most_skipped << "." << std::endl;
+            return 1;
+        }
+        int favourite = static_cast<int>(std::max_element(prior.begin(), prior.end()) - prior.begin());
+        if (favourite >= 10) {
+            favoured_high++;
+            returned_high += bid >= 10 ? 1 : 0;
+        }
+    }
+    if (favoured_high > 0 && returned_high == 0) {
+        std::cerr << "FAIL: NN1 favoured a bid of 10 or more in " << favoured_high
+                  << " positions, but the fast search never returned one." << std::endl;
+        return 1;
+    }
+    std::cout << "With NN1: searched bids follow the prior; " << returned_high << " of " << favoured_high
+              << " positions NN1 bids high in got a bid of 10 or more." << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string model_dir;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--input-model-path" && i + 1 < argc) {
+            model_dir = argv[++i];
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--input-model-path <dir with nn1_model.onnx>]\n";
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(12345);
+    try {
+        int failures = checkWithoutModels(rng);
+        if (!model_dir.empty()) {
+            failures += checkWithNN1(model_dir, rng);
+        }
+        std::cout << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+        return failures == 0 ? 0 : 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -2,11 +2,22 @@
 #include "include/Player.hpp"
 #include "include/Bot.hpp" // For RandomBot fallback in rollouts
 #include "include/MCTSBot.hpp"
+#include "include/PIMCBot.hpp"
 #include "include/GameState.hpp"
 #include "include/GameLogic.hpp"
 #include "include/UI.hpp" // Still useful for sim mode or debugging
 #include "include/ONNXModel.hpp"
+#include "include/PolicyValueModel.hpp"
+#include "include/ModelLoader.hpp"
+#include "include/ModelWatcher.hpp"
 #include "include/DataCollector.hpp"
+#include "include/DataWriter.hpp"
+#include "include/ColumnarWriter.hpp"
+#include "include/ChunkedWriter.hpp"
+#include "include/CompactWriter.hpp"
+#include "include/GameRecord.hpp"
+#include "include/ReplayBuffer.hpp"
+#include "include/ReplayServer.hpp"
 
 #include <iostream>
 #include <string>
@@ -14,99 +25,201 @@
 #include <memory>
 #include <filesystem> // For std::filesystem::exists
 #include <chrono> // For std::chrono
-#include <thread> // For std::this_thread::sleep_for (only in sim mode)
+#include <thread> // For self-play worker threads
+#include <atomic>
+#include <mutex>
 #include <random> // For sampling moves
+#include <algorithm> // For std::max
 
 
 // Forward declarations (if needed, but usually not for functions in GameLogic or UI)
 // Example for runSimulationMode if it's still needed from previous version
 
-void runSelfPlayMode(int numGames, const std::string& modelPath, const std::string& outputFile) {
-    std::shared_ptr<ONNXModel> nn1, nn2, nn3; // Shared pointers for models
-
-    try {
-        // --- Load NN3 (Win Probability) ---
-        std::string nn3_onnx_path = modelPath + "/nn3_model.onnx";
-        if (std::filesystem::exists(nn3_onnx_path)) {
-            nn3 = std::make_shared<ONNXModel>(nn3_onnx_path);
-            std::cout << "Loaded NN3 model." << std::endl;
-        }
-        else {
-            std::cerr << "FATAL: NN3 model not found at " << nn3_onnx_path << ". Cannot run self-play." << std::endl;
-            return;
-        }
-
-        // --- Load NN1 (Bidding Policy) ---
-        std::string nn1_onnx_path = modelPath + "/nn1_model.onnx";
-        if (std::filesystem::exists(nn1_onnx_path)) {
-            nn1 = std::make_shared<ONNXModel>(nn1_onnx_path);
-            std::cout << "Loaded NN1 model." << std::endl;
+enum class OutputFormat {
+    Proto,    // Size-delimited TrainingSample stream through the background DataWriter
+    Columnar, // Directory of memory-mappable .npy columns
+    Compact,  // Bit-packed records (<path> + <path>.policy)
+    Chunked,  // CRC-checked fixed-size chunks; safe for several processes appending to one file
+};
+
+// Playout-cap randomization: a random fraction of decisions gets the full search and
+// becomes a training target; the rest get a cheap search that only picks the move.
+struct PlayoutCapOptions {
+    double full_search_probability = 1.0; // 1 = every decision gets the full budget
+    int full_simulations = 50;
+    int fast_simulations = 10;
+};
+
+// A team resigns once the root value estimate (its win probability) of `consecutive`
+// of its own decisions in a row is below the threshold. A random fraction of games is
+// played on regardless, to measure how often resigning would have been wrong.
+struct ResignOptions {
+    double threshold = 0.0; // 0 disables resignation
+    int consecutive = 3;
+    double play_through_fraction = 0.1;
+};
+
+// Settings for runSelfPlayMode beyond the model files themselves.
+struct SelfPlayOptions {
+    int threads = 1;             // Worker threads, each playing whole games
+    int watch_interval_sec = 0;  // > 0 enables model hot-reload (--watch-models)
+    bool canonical_suits = false;
+    OutputFormat output_format = OutputFormat::Proto;
+    std::string game_record_path; // Non-empty: also log replayable game records (see GameRecord.hpp)
+    int replay_port = 0;          // > 0: keep samples in a ReplayBuffer served on this loopback port
+    int replay_linger_sec = 0;    // Keep serving the replay buffer this long after the last game
+    ReplayBufferOptions replay;
+    DataWriterOptions writer;
+    SamplingPolicy sampling;      // Which decisions become training samples
+    PlayoutCapOptions playout;
+    SearchBudgetOptions budget;   // Per-decision budgets within each search's nominal simulations
+    int dd_rollout_tricks = 0;    // > 0: rollouts end in a double-dummy solve once this few tricks remain
+    ResignOptions resign;
+};
+
+// Totals shared by all workers; the summary and progress lines read these.
+struct SelfPlayCounters {
+    std::atomic<long long> nn1_samples{0};
+    std::atomic<long long> nn2_samples{0};
+    std::atomic<long long> samples_written{0};
+    std::atomic<long long> full_searches{0};
+    std::atomic<long long> fast_searches{0};
+    std::atomic<long long> simulations{0};
+    std::atomic<long long> bid_searches{0};
+    std::atomic<long long> bid_simulations{0};
+    std::atomic<long long> play_searches{0};
+    std::atomic<long long> play_simulations{0};
+    std::atomic<long long> forced_moves{0};
+    std::atomic<long long> solved_moves{0};
+    std::atomic<int> claimed_rounds{0};
+    std::atomic<int> resigned_games{0};
+    std::atomic<int> play_through_games{0};
+    std::atomic<int> play_through_resign_signals{0}; // Play-through games in which a team would have resigned
+    std::atomic<int> false_resignations{0};          // ... and that team went on to win
+    std::atomic<int> games_completed{0};
+};
+
+// One worker: its own four bots, RNG stream and sample buffer, sharing the models
+// and the output writer. Pulls game indices from next_game until numGames is reached.
+static void runSelfPlayWorker(int worker_id, int numGames, std::atomic<int>& next_game, const ModelSet& models,
+                              const ModelWatcher* watcher, const SelfPlayOptions& options,
+                              std::shared_ptr<ISampleWriter> writer, GameRecordWriter* record_writer,
+                              SelfPlayCounters& counters, std::mutex& console_mutex) {
+    DataCollector data_collector(writer, options.sampling);
+    GameRecorder recorder;
+    std::vector<MCTSBot> bots;
+    for (int i = 0; i < 4; ++i) {
+        if (models.pv) {
+            bots.emplace_back(options.playout.full_simulations, models.nn1, models.pv, models.nn3); // One fused call per playing leaf
         }
         else {
-            std::cout << "NN1 model not found at " << nn1_onnx_path << ". MCTS will use random rollouts for bidding policy." << std::endl;
+            bots.emplace_back(options.playout.full_simulations, models.nn1, models.nn2, models.nn3);
         }
+        bots.back().setSuitCanonicalization(options.canonical_suits);
+        bots.back().setSearchBudget(options.budget);
+        bots.back().setDoubleDummyRollouts(options.dd_rollout_tricks);
+    }
 
-        // --- Load NN2 (Playing Policy) ---
-        std::string nn2_onnx_path = modelPath + "/nn2_model.onnx";
-        if (std::filesystem::exists(nn2_onnx_path)) {
-            nn2 = std::make_shared<ONNXModel>(nn2_onnx_path);
-            std::cout << "Loaded NN2 model." << std::endl;
+    // With --watch-models, new checkpoints are loaded in the background and each bot
+    // picks up the latest generation right before its next decision, so in-flight
+    // games continue across the switch.
+    auto syncModels = [watcher](MCTSBot& bot) {
+        if (!watcher) return;
+        std::shared_ptr<const ModelSet> latest = watcher->current();
+        if (latest->generation != bot.getModelGeneration()) {
+            bot.updateModels(*latest);
         }
-        else {
-            std::cout << "NN2 model not found at " << nn2_onnx_path << ". MCTS will use random rollouts for playing policy." << std::endl;
+    };
+
+    // Independent random stream per worker, for deals and for sampling moves
+    std::seed_seq seed{ std::random_device{}(), std::random_device{}(), static_cast<unsigned>(worker_id) };
+    std::mt19937 rng(seed);
+
+    // Picks the search budget of the bot's next decision; true for a fast (capped) search
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    auto chooseBudget = [&](MCTSBot& bot) {
+        bool fast = options.playout.full_search_probability < 1.0 && coin(rng) >= options.playout.full_search_probability;
+        bot.setSimulationsPerMove(fast ? options.playout.fast_simulations : options.playout.full_simulations);
+        (fast ? counters.fast_searches : counters.full_searches)++;
+        return fast;
+    };
+    // Tallies the budget the bot actually spent; forced moves carry no search to learn from,
+    // so they are treated like fast searches.
+    auto countBudget = [&](const MCTSBot& bot, bool isBidding, bool fast) {
+        counters.simulations += bot.getLastSimulations();
+        switch (bot.getLastSearchKind()) {
+        case SearchKind::Forced:
+            counters.forced_moves++;
+            return true;
+        case SearchKind::Solved:
+            counters.solved_moves++;
+            return fast;
+        default:
+            (isBidding ? counters.bid_searches : counters.play_searches)++;
+            (isBidding ? counters.bid_simulations : counters.play_simulations) += bot.getLastSimulations();
+            return fast;
         }
+    };
 
-    }
-    catch (const Ort::Exception& e) {
-        std::cerr << "ONNX Runtime Error during model loading: " << e.what() << std::endl;
-        return;
-    }
-    catch (const std::exception& e) {
-        std::cerr << "Standard library error during model loading: " << e.what() << std::endl;
-        return;
-    }
-
-
-    DataCollector data_collector(outputFile);
-    std::vector<MCTSBot> bots;
-    for (int i = 0; i < 4; ++i) {
-        bots.emplace_back(50, nn1, nn2, nn3); // 50 simulations per move
-    }
-
-    // Create a single random number generator for the entire self-play session
-    std::mt19937 rng(std::random_device{}());
-
-    // Counters for training data samples
-    long long nn1_sample_count = 0;
-    long long nn2_sample_count = 0;
-
-    for (int i = 0; i < numGames; ++i) {
+    for (int i = next_game.fetch_add(1); i < numGames; i = next_game.fetch_add(1)) {
         GameState state;
         int dealerIndex = i % 4; // Rotate dealer
+        long long nn1_sample_count = 0;
+        long long nn2_sample_count = 0;
+        recorder.beginGame();
+
+        const bool resign_enabled = options.resign.threshold > 0.0;
+        const bool play_through = resign_enabled && coin(rng) < options.resign.play_through_fraction;
+        int low_value_streak[2] = { 0, 0 };
+        int resigning_team = -1; // First team to meet the resignation condition
+        // Called after each search; true when the player's team resigns the game now.
+        auto shouldResign = [&](const MCTSBot& bot, int player) {
+            if (!resign_enabled || resigning_team >= 0) return false;
+            std::vector<float> value = bot.getLastValueEstimate();
+            int team = player % 2;
+            if (value.empty()) return false; // Forced move, no estimate
+            if (value[0] >= options.resign.threshold) {
+                low_value_streak[team] = 0;
+                return false;
+            }
+            if (++low_value_streak[team] < options.resign.consecutive) return false;
+            resigning_team = team;
+            return !play_through;
+        };
 
         while (!GameLogic::isGameOver(state)) {
             GameLogic::resetForNewRound(state, dealerIndex);
 
             GameLogic::initializeDeck(state.deck);
-            GameLogic::shuffleDeck(state.deck);
+            GameLogic::shuffleDeck(state.deck, rng);
             GameLogic::dealCards(state);
+            recorder.beginRound(dealerIndex, state);
 
             // --- Bidding Phase ---
             for (int p_turn = 0; p_turn < 4; ++p_turn) {
                 int current_player_idx = state.currentPlayerIndex; // The player whose turn it is to bid
 
+                syncModels(bots[current_player_idx]);
+                bool fast_search = chooseBudget(bots[current_player_idx]);
+
                 // Run MCTS to get the improved policy, but ignore the "best" bid it returns.
                 // The primary goal here is to populate the bot's internal policy vector.
                 bots[current_player_idx].getBid(state.players[current_player_idx], state);
+                fast_search = countBudget(bots[current_player_idx], true, fast_search);
 
-                // Record the MCTS policy (visit counts) as the training target.
-                data_collector.record(state, bots[current_player_idx], true);
+                // Record the MCTS policy (visit counts) as the training target (fast searches
+                // are dropped by the collector unless they are wanted).
+                data_collector.record(state, bots[current_player_idx], true, fast_search);
                 nn1_sample_count++;
 
                 // Now, sample a bid from that MCTS policy for exploration during gameplay.
                 auto policy = bots[current_player_idx].getLastActionProbs();
                 std::discrete_distribution<> dist(policy.begin(), policy.end());
                 int sampledBid = dist(rng);
+                recorder.recordBid(current_player_idx, sampledBid, bots[current_player_idx], fast_search);
+                if (shouldResign(bots[current_player_idx], current_player_idx)) {
+                    goto end_of_game_self_play;
+                }
 
                 // Apply the *sampled* bid to the game state
                 state.players[current_player_idx].bid = sampledBid;
@@ -116,11 +229,13 @@ void runSelfPlayMode(int numGames, const std::string& modelPath, const std::stri
             // --- Playing Phase (13 Tricks) ---
             for (int trick_num = 0; trick_num < 13; ++trick_num) {
                 for (int turn_in_trick = 0; turn_in_trick < 4; ++turn_in_trick) {
-                    // Check for TRAM (The Rest Are Mine) condition
-                    if (GameLogic::canTram(state)) {
-                        int remainingTricks = 13 - trick_num; // tricks_num is 0-indexed
-                        state.players[state.currentPlayerIndex].tricksWon += remainingTricks;
-                        // Fast forward to end of round after TRAM
+                    // Claim: the remaining tricks are decided whatever anyone plays
+                    std::array<int, 4> claimed;
+                    if (GameLogic::findClaim(state, claimed)) {
+                        GameLogic::applyClaim(state, claimed);
+                        recorder.recordClaim(claimed);
+                        counters.claimed_rounds++;
+                        // Fast forward to end of round after the claim
                         goto end_of_round_self_play;
                     }
 
@@ -134,17 +249,25 @@ void runSelfPlayMode(int numGames, const std::string& modelPath, const std::stri
                         break;
                     }
 
+                    syncModels(bots[current_player_idx]);
+                    bool fast_search = chooseBudget(bots[current_player_idx]);
+
                     // Run MCTS search to get the improved policy, ignoring the returned best move.
                     bots[current_player_idx].getMove(state, validMoves);
+                    fast_search = countBudget(bots[current_player_idx], false, fast_search);
 
                     // Record the MCTS policy as the training target *before* applying the move.
-                    data_collector.record(state, bots[current_player_idx], false);
+                    data_collector.record(state, bots[current_player_idx], false, fast_search);
                     nn2_sample_count++;
 
                     // Sample a move from the MCTS policy distribution for exploration.
                     auto policy = bots[current_player_idx].getLastActionProbs();
                     std::discrete_distribution<> dist(policy.begin(), policy.end());
                     int sampledMoveIndex = dist(rng);
+                    recorder.recordPlay(current_player_idx, state.players[current_player_idx].hand[sampledMoveIndex], bots[current_player_idx], fast_search);
+                    if (shouldResign(bots[current_player_idx], current_player_idx)) {
+                        goto end_of_game_self_play;
+                    }
 
                     // Apply the *sampled* card play to the game state
                     GameLogic::applyMove(state, sampledMoveIndex); // This also advances currentPlayerIndex and handles trick winner/reset
@@ -160,9 +283,17 @@ void runSelfPlayMode(int numGames, const std::string& modelPath, const std::stri
             dealerIndex = (dealerIndex + 1) % 4; // Rotate dealer for next round
         } // End of game loop
 
+    end_of_game_self_play:; // Label for goto (resignation)
+
         // Determine final game winner to finalize data
         int winning_team_id = -1; // 0 for Team 1, 1 for Team 2
-        if (state.team1Score > state.team2Score) {
+        if (resigning_team >= 0 && !play_through) {
+            // The resigning team is labelled as having lost every sample of the game
+            winning_team_id = 1 - resigning_team;
+            recorder.recordResign(resigning_team);
+            counters.resigned_games++;
+        }
+        else if (state.team1Score > state.team2Score) {
             winning_team_id = 0;
         }
         else if (state.team2Score > state.team1Score) {
@@ -173,36 +304,359 @@ void runSelfPlayMode(int numGames, const std::string& modelPath, const std::stri
             // For simplicity, let's say Team 1 wins on tie for training label if 1/0 is expected
             winning_team_id = 0;
         }
+        if (play_through) {
+            counters.play_through_games++;
+            if (resigning_team >= 0) {
+                counters.play_through_resign_signals++;
+                if (resigning_team == winning_team_id) counters.false_resignations++;
+            }
+        }
+        uint64_t written_before = data_collector.samplesWritten();
         data_collector.finalize(winning_team_id);
+        counters.samples_written += static_cast<long long>(data_collector.samplesWritten() - written_before);
+        if (record_writer) {
+            recorder.endGame(winning_team_id);
+            record_writer->writeGame(recorder.bytes());
+        }
+
+        counters.nn1_samples += nn1_sample_count;
+        counters.nn2_samples += nn2_sample_count;
+        int completed = ++counters.games_completed;
+        if (completed % 10 == 0) {
+            std::lock_guard<std::mutex> lock(console_mutex);
+            std::cout << "Generated " << completed << " / " << numGames << " games... "
+                << "(NN1 Bids: " << counters.nn1_samples.load()
+                << ", NN2 Plays: " << counters.nn2_samples.load() << ")" << std::endl;
+        }
+    }
+}
+
+void runSelfPlayMode(int numGames, const std::string& modelPath, const std::string& outputFile, const ModelLoadOptions& loadOptions,
+                     const SelfPlayOptions& options) {
+    ModelSet models; // Shared pointers for models
+
+    try {
+        models = loadModelSet(modelPath, loadOptions);
+    }
+    catch (const Ort::Exception& e) {
+        std::cerr << "ONNX Runtime Error during model loading: " << e.what() << std::endl;
+        return;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "FATAL: " << e.what() << std::endl;
+        return;
+    }
+
+    std::unique_ptr<ModelWatcher> watcher;
+    if (options.watch_interval_sec > 0) {
+        watcher = std::make_unique<ModelWatcher>(modelPath, loadOptions, models, std::chrono::seconds(options.watch_interval_sec));
+        std::cout << "Watching " << modelPath << " for new models every " << options.watch_interval_sec << " s." << std::endl;
+    }
+
+    std::shared_ptr<DataWriter> stream_writer;
+    std::shared_ptr<ColumnarWriter> columnar_writer;
+    std::shared_ptr<CompactWriter> compact_writer;
+    std::shared_ptr<ChunkedWriter> chunked_writer;
+    std::shared_ptr<ISampleWriter> writer;
+    if (options.output_format == OutputFormat::Columnar) {
+        writer = columnar_writer = std::make_shared<ColumnarWriter>(outputFile);
+    }
+    else if (options.output_format == OutputFormat::Compact) {
+        writer = compact_writer = std::make_shared<CompactWriter>(outputFile);
+    }
+    else if (options.output_format == OutputFormat::Chunked) {
+        writer = chunked_writer = std::make_shared<ChunkedWriter>(outputFile);
+    }
+    else {
+        writer = stream_writer = std::make_shared<DataWriter>(outputFile, options.writer);
+    }
+    std::shared_ptr<ReplayBuffer> replay_buffer;
+    std::unique_ptr<ReplayServer> replay_server;
+    if (options.replay_port > 0) {
+        ReplayBufferOptions replay_options = options.replay;
+        replay_options.shards = std::max<size_t>(replay_options.shards, static_cast<size_t>(std::max(1, options.threads)));
+        replay_buffer = std::make_shared<ReplayBuffer>(replay_options);
+        replay_server = std::make_unique<ReplayServer>(*replay_buffer, static_cast<uint16_t>(options.replay_port));
+        writer = std::make_shared<SampleWriterFanOut>(std::vector<std::shared_ptr<ISampleWriter>>{ writer, replay_buffer });
+        std::cout << "Serving a " << replay_buffer->capacity() << "-sample replay buffer on 127.0.0.1:" << options.replay_port << std::endl;
+    }
+    std::unique_ptr<GameRecordWriter> record_writer;
+    if (!options.game_record_path.empty()) {
+        record_writer = std::make_unique<GameRecordWriter>(options.game_record_path);
+    }
+    SelfPlayCounters counters;
+    std::atomic<int> next_game{0};
+    std::mutex console_mutex;
+
+    int thread_count = std::max(1, std::min(options.threads, numGames));
+    std::cout << "Running self-play on " << thread_count << " thread(s)." << std::endl;
+    auto start = std::chrono::steady_clock::now();
 
-        if ((i + 1) % 10 == 0) {
-            std::cout << "Generated " << i + 1 << " / " << numGames << " games... "
-                << "(NN1 Bids: " << nn1_sample_count
-                << ", NN2 Plays: " << nn2_sample_count << ")" << std::endl;
+    auto worker = [&](int worker_id) {
+        try {
+            runSelfPlayWorker(worker_id, numGames, next_game, models, watcher.get(), options, writer, record_writer.get(), counters, console_mutex);
+        }
+        catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lock(console_mutex);
+            std::cerr << "Self-play worker " << worker_id << " stopped: " << e.what() << std::endl;
         }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < thread_count; ++t) {
+        workers.emplace_back(worker, t);
     }
+    worker(0);
+    for (auto& t : workers) {
+        t.join();
+    }
+    try {
+        writer->close(); // Drain the write-behind queue / publish column sizes before reporting
+        if (record_writer) {
+            record_writer->close();
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "FATAL: " << e.what() << std::endl;
+    }
+    double elapsed_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
     // Final Summary
+    long long nn1_sample_count = counters.nn1_samples.load();
+    long long nn2_sample_count = counters.nn2_samples.load();
+    int games_completed = counters.games_completed.load();
     std::cout << "\n--- Data Generation Summary ---" << std::endl;
-    std::cout << "Total Games Generated: " << numGames << std::endl;
+    std::cout << "Total Games Generated: " << games_completed << " in " << elapsed_sec << " s ("
+        << games_completed / std::max(elapsed_sec, 1e-9) << " games/s on " << thread_count << " thread(s))" << std::endl;
     std::cout << "Bidding Model (NN1) Training Samples: " << nn1_sample_count << std::endl;
     std::cout << "Playing Model (NN2) Training Samples: " << nn2_sample_count << std::endl;
     long long total_samples = nn1_sample_count + nn2_sample_count;
     std::cout << "Value Model (NN3) Training Samples: " << total_samples << std::endl;
     std::cout << "(Each bid and play decision point serves as a state for the value model)." << std::endl;
+    std::cout << "Rounds ended early by a claim: " << counters.claimed_rounds.load() << std::endl;
+    if (counters.fast_searches.load() > 0) {
+        std::cout << "Playout cap: " << counters.full_searches.load() << " full searches (" << options.playout.full_simulations
+            << " simulations), " << counters.fast_searches.load() << " fast searches (" << options.playout.fast_simulations
+            << "); " << counters.simulations.load() / std::max(elapsed_sec, 1e-9) << " simulations/s" << std::endl;
+    }
+    if (options.budget.enabled) {
+        auto average = [](long long total, long long count) { return count > 0 ? static_cast<double>(total) / count : 0.0; };
+        std::cout << "Search budget: " << counters.bid_searches.load() << " bid searches averaging "
+            << average(counters.bid_simulations.load(), counters.bid_searches.load()) << " simulations, "
+            << counters.play_searches.load() << " play searches averaging "
+            << average(counters.play_simulations.load(), counters.play_searches.load()) << "; "
+            << counters.forced_moves.load() << " forced moves, " << counters.solved_moves.load() << " solved exactly" << std::endl;
+    }
+    if (options.resign.threshold > 0.0) {
+        std::cout << "Resignation: " << counters.resigned_games.load() << " games resigned; "
+            << counters.play_through_games.load() << " played through, in " << counters.play_through_resign_signals.load()
+            << " of which a team would have resigned and " << counters.false_resignations.load() << " of those went on to win";
+        if (counters.play_through_resign_signals.load() > 0) {
+            std::cout << " (false resignation rate " << 100.0 * counters.false_resignations.load() / counters.play_through_resign_signals.load() << "%)";
+        }
+        std::cout << std::endl;
+    }
+    if (counters.samples_written.load() != total_samples) {
+        std::cout << "Sampling policy kept " << counters.samples_written.load() << " of these " << total_samples << " decisions." << std::endl;
+    }
+    reportCacheStats(watcher ? *watcher->current() : models);
+    if (stream_writer) {
+        DataWriterStats writer_stats = stream_writer->stats();
+        std::cout << "Data writer: " << writer_stats.bytes_written << " bytes in " << writer_stats.blocks_written << " blocks, "
+            << writer_stats.syncs << " syncs; producers stalled " << writer_stats.producer_stalls << " times ("
+            << writer_stats.producer_stall_ms << " ms), peak queue depth " << writer_stats.max_queue_depth << std::endl;
+    }
+    else if (compact_writer) {
+        std::cout << "Compact dataset: " << compact_writer->records() << " records in total, "
+            << compact_writer->bytesWritten() << " bytes written this run";
+        if (compact_writer->skippedSamples() > 0) {
+            std::cout << " (" << compact_writer->skippedSamples() << " samples not representable, skipped)";
+        }
+        std::cout << std::endl;
+    }
+    else if (chunked_writer) {
+        std::cout << "Chunked data: " << chunked_writer->records() << " samples in " << chunked_writer->chunks()
+            << " chunks this run" << std::endl;
+    }
+    else {
+        std::cout << "Columnar dataset: " << columnar_writer->bidRows() << " bidding rows, "
+            << columnar_writer->playRows() << " playing rows in total" << std::endl;
+    }
+    if (replay_buffer) {
+        std::cout << "Replay buffer: " << replay_buffer->size() << " of " << replay_buffer->inserted() << " inserted samples held, "
+            << replay_server->batchesServed() << " minibatches served" << std::endl;
+    }
+    if (record_writer) {
+        std::cout << "Game records: " << record_writer->games() << " games appended to " << options.game_record_path << std::endl;
+    }
     std::cout << "---------------------------------" << std::endl;
     std::cout << "Self-play data generation complete. Saved to " << outputFile << std::endl;
+    if (replay_server && options.replay_linger_sec > 0) {
+        std::cout << "Serving the replay buffer for another " << options.replay_linger_sec << " s..." << std::endl;
+        std::this_thread::sleep_for(std::chrono::seconds(options.replay_linger_sec));
+    }
+}
+
+
+// MCTSBot against PIMCBot, each decision taken greedily. Games come in pairs on the
+// same deals with the teams' seats swapped, so neither side keeps the luck of the cards.
+void runArenaMode(int numGames, const std::string& modelPath, const ModelLoadOptions& loadOptions,
+                  const SelfPlayOptions& options, const PIMCOptions& pimcOptions) {
+    ModelSet models;
+    try {
+        models = loadModelSet(modelPath, loadOptions);
+    }
+    catch (const Ort::Exception& e) {
+        std::cerr << "ONNX Runtime Error during model loading: " << e.what() << std::endl;
+        return;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "FATAL: " << e.what() << std::endl;
+        return;
+    }
+
+    std::vector<MCTSBot> mcts_bots;
+    for (int i = 0; i < 4; ++i) {
+        if (models.pv) {
+            mcts_bots.emplace_back(options.playout.full_simulations, models.nn1, models.pv, models.nn3);
+        }
+        else {
+            mcts_bots.emplace_back(options.playout.full_simulations, models.nn1, models.nn2, models.nn3);
+        }
+        mcts_bots.back().setSuitCanonicalization(options.canonical_suits);
+        mcts_bots.back().setSearchBudget(options.budget);
+        mcts_bots.back().setDoubleDummyRollouts(options.dd_rollout_tricks);
+    }
+    PIMCBot pimc(pimcOptions); // Serves both of its team's seats
+    std::cout << "Arena: MCTSBot (" << options.playout.full_simulations << " simulations) vs PIMCBot ("
+        << pimcOptions.samples << " deals per decision on " << pimc.threads() << " thread(s)), " << numGames << " games." << std::endl;
+
+    enum { kMCTS = 0, kPIMC = 1 };
+    int wins[2] = { 0, 0 };
+    long long points[2] = { 0, 0 };
+    long long decisions[2] = { 0, 0 };
+    double think_seconds[2] = { 0.0, 0.0 };
+    const uint32_t deal_seed = std::random_device{}();
+
+    for (int g = 0; g < numGames; ++g) {
+        const int pimc_team = g % 2;
+        std::mt19937 rng(deal_seed + static_cast<uint32_t>(g / 2)); // Both games of a pair see the same deals
+        GameState state;
+        int dealerIndex = (g / 2) % 4;
+        // Times one decision of `player` and credits it to that player's side
+        auto decide = [&](int player, auto&& choose) {
+            int side = player % 2 == pimc_team ? kPIMC : kMCTS;
+            auto start = std::chrono::steady_clock::now();
+            int choice = choose(side == kPIMC ? static_cast<IBot&>(pimc) : static_cast<IBot&>(mcts_bots[player]));
+            think_seconds[side] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            decisions[side]++;
+            return choice;
+        };
+
+        while (!GameLogic::isGameOver(state)) {
+            GameLogic::resetForNewRound(state, dealerIndex);
+            GameLogic::initializeDeck(state.deck);
+            GameLogic::shuffleDeck(state.deck, rng);
+            GameLogic::dealCards(state);
+
+            for (int p_turn = 0; p_turn < 4; ++p_turn) {
+                int player = state.currentPlayerIndex;
+                int bid = decide(player, [&](IBot& bot) { return bot.getBid(state.players[player], state); });
+                GameLogic::applyBid(state, bid);
+            }
+            while (!GameLogic::isRoundOver(state)) {
+                std::array<int, 4> claimed;
+                if (GameLogic::findClaim(state, claimed)) {
+                    GameLogic::applyClaim(state, claimed);
+                    break;
+                }
+                auto validMoves = GameLogic::getValidMoves(state);
+                if (validMoves.empty()) break;
+                int move = decide(state.currentPlayerIndex, [&](IBot& bot) { return bot.getMove(state, validMoves); });
+                GameLogic::applyMove(state, move);
+            }
+
+            int team1RoundPoints, team2RoundPoints;
+            GameLogic::updateScores(state, team1RoundPoints, team2RoundPoints);
+            dealerIndex = (dealerIndex + 1) % 4;
+        }
+
+        int pimc_score = pimc_team == 0 ? state.team1Score : state.team2Score;
+        int mcts_score = pimc_team == 0 ? state.team2Score : state.team1Score;
+        points[kPIMC] += pimc_score;
+        points[kMCTS] += mcts_score;
+        if (pimc_score != mcts_score) {
+            wins[pimc_score > mcts_score ? kPIMC : kMCTS]++;
+        }
+        std::cout << "Game " << g + 1 << ": PIMCBot (team " << pimc_team + 1 << ") " << pimc_score
+            << " - MCTSBot " << mcts_score << std::endl;
+    }
+
+    auto perDecisionMs = [&](int side) { return decisions[side] > 0 ? 1000.0 * think_seconds[side] / decisions[side] : 0.0; };
+    std::cout << "\n--- Arena Summary ---" << std::endl;
+    std::cout << "PIMCBot: " << wins[kPIMC] << " wins, " << static_cast<double>(points[kPIMC]) / std::max(1, numGames)
+        << " points per game, " << perDecisionMs(kPIMC) << " ms per decision, " << pimc.samplesPerSecond() << " deals solved/s" << std::endl;
+    std::cout << "MCTSBot: " << wins[kMCTS] << " wins, " << static_cast<double>(points[kMCTS]) / std::max(1, numGames)
+        << " points per game, " << perDecisionMs(kMCTS) << " ms per decision" << std::endl;
+    std::cout << "Ties: " << numGames - wins[kPIMC] - wins[kMCTS] << std::endl;
 }
 
 
 int main(int argc, char* argv[]) {
     // Command line argument parsing
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " --mode self-play [options]\n";
+        std::cerr << "Usage: " << argv[0] << " --mode <self-play|arena> [options]\n";
         std::cerr << "Options for self-play mode:\n";
         std::cerr << "  --games <number> (required) : Number of self-play games to generate.\n";
-        std::cerr << "  --output-data-path <filename.bin> (required) : Path to save the generated binary training data.\n";
+        std::cerr << "  --output-data-path <filename.bin> (required) : Path to save the generated binary training data (a directory with --output-format columnar).\n";
         std::cerr << "  --input-model-path <directory> (required) : Directory containing nnX_model.onnx files.\n";
+        std::cerr << "  --threads <n> : Play games on n worker threads sharing the loaded models (default 1).\n";
+        std::cerr << "  --output-format <proto|columnar|compact|chunked> : columnar writes a directory of memory-mappable .npy columns, compact writes bit-packed records about 10x smaller than proto, chunked writes CRC-checked chunks that several processes can append to (default proto).\n";
+        std::cerr << "  --replay-port <port> : Also keep samples in an in-memory replay buffer served to the trainer on 127.0.0.1:<port>.\n";
+        std::cerr << "  --replay-capacity <n> : Samples held by the replay buffer (default 1048576).\n";
+        std::cerr << "  --replay-half-life <n> : Age in samples at which recency-weighted sampling halves a sample's weight (default capacity / 4).\n";
+        std::cerr << "  --replay-linger-sec <n> : Keep serving the replay buffer n seconds after the last game (default 0).\n";
+        std::cerr << "  --simulations <n> : MCTS simulations of a full search (default 50).\n";
+        std::cerr << "  --full-search-prob <p> : Playout-cap randomization: only this fraction of decisions gets a full search and is recorded (default 1).\n";
+        std::cerr << "  --fast-simulations <n> : Simulations of the other, move-picking searches (default 10).\n";
+        std::cerr << "  --record-fast-searches : Record fast searches too, flagged fast_search (e.g. as value targets).\n";
+        std::cerr << "  --budget-scheduler : Spend each search's simulations by decision: none on forced moves, more with more options and earlier in the round, banking the difference.\n";
+        std::cerr << "  --min-simulations <n> : ... but at least n simulations per search (default 8).\n";
+        std::cerr << "  --exact-solve-tricks <n> : ... and solve the card play exactly once n tricks remain, at most 4 (default 3, 0 = never).\n";
+        std::cerr << "  --dd-rollout-tricks <n> : Finish rollouts with a double-dummy solve once n tricks remain, instead of random play (default 0 = never; no effect with --fused, which has no rollouts).\n";
+        std::cerr << "  --resign-threshold <v> : A team resigns when its root win probability stays below v (default 0 = never).\n";
+        std::cerr << "  --resign-consecutive <n> : ... for n of its own decisions in a row (default 3).\n";
+        std::cerr << "  --resign-play-through <f> : Fraction of games played on regardless, to measure false resignations (default 0.1).\n";
+        std::cerr << "  --sample-rate <p> : Record each decision with probability p (default 1).\n";
+        std::cerr << "  --max-samples-per-round <n> : Record a uniform subset of at most n decisions per round (default 0 = all).\n";
+        std::cerr << "  --max-samples-per-game <n> : Reservoir-sample at most n decisions per game (default 0 = all).\n";
+        std::cerr << "  --game-record-path <file> : Also append replayable game records (deals, moves, visit counts) for replay_records.\n";
+        std::cerr << "  --write-queue <n> : Finished games buffered for the background writer (default 256).\n";
+        std::cerr << "  --write-block-mb <n> : Size of each block written to the output file (default 4).\n";
+        std::cerr << "  --fsync-every-mb <n> : fdatasync the output after every n MiB (default 0 = never).\n";
+        std::cerr << "  --no-index : Do not maintain the <output>.idx record index (see build_index).\n";
+        std::cerr << "  --quantized : Prefer int8 nnX_model.int8.onnx files (see quantize_models.py) when present.\n";
+        std::cerr << "  --fused : Use the two-headed pv_model.onnx for playing searches instead of NN2 + NN3 rollouts.\n";
+        std::cerr << "  --no-model-cache : Do not read or write serialized optimized graphs (<model>.opt-*.ort).\n";
+        std::cerr << "  --no-warmup : Skip the dummy inference run after loading each model.\n";
+        std::cerr << "  --inference-cache-mb <n> : Memoize model outputs for repeated inputs, up to n MiB per model.\n";
+        std::cerr << "  --canonical-suits : Evaluate playing positions with side suits in canonical order (more cache hits).\n";
+        std::cerr << "  --watch-models : Hot-reload new models from --input-model-path without restarting.\n";
+        std::cerr << "  --watch-interval-sec <n> : Poll interval for --watch-models (default 30).\n";
+        std::cerr << "Arena mode: MCTSBot against PIMCBot over --games games from --input-model-path, on paired deals with seats swapped.\n";
+        std::cerr << "  MCTSBot takes the search options above (--simulations, --budget-scheduler, --dd-rollout-tricks, ...).\n";
+        std::cerr << "  --pimc-samples <n> : Deals PIMCBot solves per decision (default 32).\n";
+        std::cerr << "  --pimc-threads <n> : PIMCBot solver threads (default 0 = one per core).\n";
+        std::cerr << "ONNX Runtime options (shared by all models):\n";
+        std::cerr << "  --intra-op-threads <n> : Intra-op threads (0 = ORT default).\n";
+        std::cerr << "  --inter-op-threads <n> : Inter-op threads (0 = ORT default).\n";
+        std::cerr << "  --per-session-threads : Give each model its own thread pool instead of one global pool.\n";
+        std::cerr << "  --graph-opt-level <disable|basic|extended|all> : Graph optimization level (default all).\n";
+        std::cerr << "  --execution-mode <sequential|parallel> : Operator execution mode (default sequential).\n";
+        std::cerr << "  --no-cpu-arena : Disable the CPU memory arena.\n";
+        std::cerr << "  --no-mem-pattern : Disable memory pattern planning.\n";
+        std::cerr << "  --shared-arena : Share one env-registered arena across all model sessions.\n";
+        std::cerr << "  --arena-max-mb <n> : Cap for the shared arena in MiB (0 = unlimited).\n";
+        std::cerr << "  --arena-extend <power-of-two|requested> : Shared arena growth strategy.\n";
         // Optionally add a verbose mode
         return 1;
     }
@@ -211,6 +665,12 @@ int main(int argc, char* argv[]) {
     int numGames = 0;
     std::string outputFile = "";
     std::string inputModelPath = "models"; // Default, but required to be passed
+    ModelLoadOptions loadOptions;
+    ONNXSessionConfig sessionConfig;
+    SelfPlayOptions selfPlayOptions;
+    PIMCOptions pimcOptions;
+    bool watchModels = false;
+    int watchIntervalSec = 30;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -226,6 +686,170 @@ int main(int argc, char* argv[]) {
         else if (arg == "--input-model-path" && i + 1 < argc) {
             inputModelPath = argv[++i];
         }
+        else if (arg == "--quantized") {
+            loadOptions.prefer_quantized = true;
+        }
+        else if (arg == "--fused") {
+            loadOptions.fused = true;
+        }
+        else if (arg == "--no-model-cache") {
+            loadOptions.use_optimized_cache = false;
+        }
+        else if (arg == "--no-warmup") {
+            loadOptions.warmup = false;
+        }
+        else if (arg == "--inference-cache-mb" && i + 1 < argc) {
+            loadOptions.inference_cache_bytes = static_cast<size_t>(std::stoll(argv[++i])) * 1024 * 1024;
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            selfPlayOptions.threads = std::stoi(argv[++i]);
+        }
+        else if (arg == "--replay-port" && i + 1 < argc) {
+            selfPlayOptions.replay_port = std::stoi(argv[++i]);
+        }
+        else if (arg == "--replay-capacity" && i + 1 < argc) {
+            selfPlayOptions.replay.capacity = static_cast<size_t>(std::stoll(argv[++i]));
+        }
+        else if (arg == "--replay-half-life" && i + 1 < argc) {
+            selfPlayOptions.replay.recency_half_life = std::stod(argv[++i]);
+        }
+        else if (arg == "--replay-linger-sec" && i + 1 < argc) {
+            selfPlayOptions.replay_linger_sec = std::stoi(argv[++i]);
+        }
+        else if (arg == "--simulations" && i + 1 < argc) {
+            selfPlayOptions.playout.full_simulations = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--full-search-prob" && i + 1 < argc) {
+            selfPlayOptions.playout.full_search_probability = std::clamp(std::stod(argv[++i]), 0.0, 1.0);
+        }
+        else if (arg == "--fast-simulations" && i + 1 < argc) {
+            selfPlayOptions.playout.fast_simulations = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--record-fast-searches") {
+            selfPlayOptions.sampling.record_fast_searches = true;
+        }
+        else if (arg == "--budget-scheduler") {
+            selfPlayOptions.budget.enabled = true;
+        }
+        else if (arg == "--min-simulations" && i + 1 < argc) {
+            selfPlayOptions.budget.min_simulations = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--exact-solve-tricks" && i + 1 < argc) {
+            // The solver is exhaustive: beyond four tricks it costs more than the search it replaces
+            selfPlayOptions.budget.exact_solve_tricks = std::clamp(std::stoi(argv[++i]), 0, 4);
+        }
+        else if (arg == "--dd-rollout-tricks" && i + 1 < argc) {
+            selfPlayOptions.dd_rollout_tricks = std::clamp(std::stoi(argv[++i]), 0, 13);
+        }
+        else if (arg == "--pimc-samples" && i + 1 < argc) {
+            pimcOptions.samples = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--pimc-threads" && i + 1 < argc) {
+            pimcOptions.threads = std::max(0, std::stoi(argv[++i]));
+        }
+        else if (arg == "--resign-threshold" && i + 1 < argc) {
+            selfPlayOptions.resign.threshold = std::clamp(std::stod(argv[++i]), 0.0, 1.0);
+        }
+        else if (arg == "--resign-consecutive" && i + 1 < argc) {
+            selfPlayOptions.resign.consecutive = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--resign-play-through" && i + 1 < argc) {
+            selfPlayOptions.resign.play_through_fraction = std::clamp(std::stod(argv[++i]), 0.0, 1.0);
+        }
+        else if (arg == "--sample-rate" && i + 1 < argc) {
+            selfPlayOptions.sampling.keep_probability = std::clamp(std::stod(argv[++i]), 0.0, 1.0);
+        }
+        else if (arg == "--max-samples-per-round" && i + 1 < argc) {
+            selfPlayOptions.sampling.max_per_round = std::max(0, std::stoi(argv[++i]));
+        }
+        else if (arg == "--max-samples-per-game" && i + 1 < argc) {
+            selfPlayOptions.sampling.max_per_game = std::max(0, std::stoi(argv[++i]));
+        }
+        else if (arg == "--game-record-path" && i + 1 < argc) {
+            selfPlayOptions.game_record_path = argv[++i];
+        }
+        else if (arg == "--output-format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format == "proto") selfPlayOptions.output_format = OutputFormat::Proto;
+            else if (format == "columnar") selfPlayOptions.output_format = OutputFormat::Columnar;
+            else if (format == "compact") selfPlayOptions.output_format = OutputFormat::Compact;
+            else if (format == "chunked") selfPlayOptions.output_format = OutputFormat::Chunked;
+            else {
+                std::cerr << "Error: Unknown --output-format '" << format << "'.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--write-queue" && i + 1 < argc) {
+            selfPlayOptions.writer.queue_capacity = static_cast<size_t>(std::stoll(argv[++i]));
+        }
+        else if (arg == "--write-block-mb" && i + 1 < argc) {
+            selfPlayOptions.writer.block_bytes = static_cast<size_t>(std::stoll(argv[++i])) * 1024 * 1024;
+        }
+        else if (arg == "--no-index") {
+            selfPlayOptions.writer.write_index = false;
+        }
+        else if (arg == "--fsync-every-mb" && i + 1 < argc) {
+            selfPlayOptions.writer.sync_every_bytes = static_cast<size_t>(std::stoll(argv[++i])) * 1024 * 1024;
+        }
+        else if (arg == "--canonical-suits") {
+            selfPlayOptions.canonical_suits = true;
+        }
+        else if (arg == "--watch-models") {
+            watchModels = true;
+        }
+        else if (arg == "--watch-interval-sec" && i + 1 < argc) {
+            watchIntervalSec = std::stoi(argv[++i]);
+        }
+        else if (arg == "--intra-op-threads" && i + 1 < argc) {
+            sessionConfig.intra_op_threads = std::stoi(argv[++i]);
+        }
+        else if (arg == "--inter-op-threads" && i + 1 < argc) {
+            sessionConfig.inter_op_threads = std::stoi(argv[++i]);
+        }
+        else if (arg == "--per-session-threads") {
+            sessionConfig.use_global_thread_pool = false;
+        }
+        else if (arg == "--graph-opt-level" && i + 1 < argc) {
+            std::string level = argv[++i];
+            if (level == "disable") sessionConfig.graph_optimization_level = ORT_DISABLE_ALL;
+            else if (level == "basic") sessionConfig.graph_optimization_level = ORT_ENABLE_BASIC;
+            else if (level == "extended") sessionConfig.graph_optimization_level = ORT_ENABLE_EXTENDED;
+            else if (level == "all") sessionConfig.graph_optimization_level = ORT_ENABLE_ALL;
+            else {
+                std::cerr << "Error: Unknown --graph-opt-level '" << level << "'.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--execution-mode" && i + 1 < argc) {
+            std::string executionMode = argv[++i];
+            if (executionMode == "sequential") sessionConfig.execution_mode = ORT_SEQUENTIAL;
+            else if (executionMode == "parallel") sessionConfig.execution_mode = ORT_PARALLEL;
+            else {
+                std::cerr << "Error: Unknown --execution-mode '" << executionMode << "'.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--no-cpu-arena") {
+            sessionConfig.enable_cpu_mem_arena = false;
+        }
+        else if (arg == "--no-mem-pattern") {
+            sessionConfig.enable_mem_pattern = false;
+        }
+        else if (arg == "--shared-arena") {
+            sessionConfig.share_arena_across_sessions = true;
+        }
+        else if (arg == "--arena-max-mb" && i + 1 < argc) {
+            sessionConfig.arena_max_bytes = static_cast<size_t>(std::stoll(argv[++i])) * 1024 * 1024;
+        }
+        else if (arg == "--arena-extend" && i + 1 < argc) {
+            std::string strategy = argv[++i];
+            if (strategy == "power-of-two") sessionConfig.arena_extend_strategy = 0;
+            else if (strategy == "requested") sessionConfig.arena_extend_strategy = 1;
+            else {
+                std::cerr << "Error: Unknown --arena-extend '" << strategy << "'.\n";
+                return 1;
+            }
+        }
     }
 
     if (mode == "self-play") {
@@ -233,10 +857,22 @@ int main(int argc, char* argv[]) {
             std::cerr << "Error: --games, --output-data-path, and --input-model-path are all required for self-play mode.\n";
             return 1;
         }
-        runSelfPlayMode(numGames, inputModelPath, outputFile);
+        ONNXModel::configureRuntime(sessionConfig);
+        if (watchModels) {
+            selfPlayOptions.watch_interval_sec = std::max(1, watchIntervalSec);
+        }
+        runSelfPlayMode(numGames, inputModelPath, outputFile, loadOptions, selfPlayOptions);
+    }
+    else if (mode == "arena") {
+        if (numGames <= 0 || inputModelPath.empty()) {
+            std::cerr << "Error: --games and --input-model-path are required for arena mode.\n";
+            return 1;
+        }
+        ONNXModel::configureRuntime(sessionConfig);
+        runArenaMode(numGames, inputModelPath, loadOptions, selfPlayOptions, pimcOptions);
     }
     else {
-        std::cerr << "Error: Invalid or unsupported mode specified. Only 'self-play' is supported in this build.\n";
+        std::cerr << "Error: Invalid or unsupported mode specified. Use 'self-play' or 'arena'.\n";
         return 1;
     }
 
@@ -0,0 +1,443 @@
+#include "include/ChunkedWriter.hpp"
+#include "include/ColumnarWriter.hpp"
+#include "include/CompactWriter.hpp"
+#include "include/DataWriter.hpp"
+#include "include/SampleReader.hpp"
+#include "include/test.pb.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Globally shuffles any number of training files (size-delimited Protobuf, chunked or compact)
+// into N evenly sized shards, with memory bounded by --memory-mb instead of the
+// dataset size. Two passes over the data:
+//   1. Scatter: every sample is appended to one of B temporary bucket files, chosen
+//      uniformly at random. B is picked so a bucket fits in each worker's share of memory.
+//   2. Gather: each bucket is loaded, shuffled in memory and dealt out. The buckets laid
+//      end to end form one random permutation of the dataset; shard k receives positions
+//      [k * total / N, (k + 1) * total / N) of it, so shard sizes differ by at most one.
+
+namespace fs = std::filesystem;
+
+static constexpr size_t kWriteBatch = 512;               // Samples per writeGame call on a shard
+static constexpr size_t kMinBucketBuffer = 4 * 1024;     // Per-thread staging before a bucket append
+static constexpr size_t kMaxBucketBuffer = 256 * 1024;
+static constexpr uint64_t kMinChunkedSplit = 16 * 1024 * 1024; // Chunked inputs are split into ranges at least this large
+static constexpr double kCompactExpansion = 8.0;         // Compact bytes -> Protobuf bytes, roughly
+static constexpr double kInMemoryOverhead = 1.5;         // Serialized bytes -> std::string in a vector
+
+enum class ShardFormat { Proto, Columnar, Compact, Chunked };
+
+struct ShuffleOptions {
+    std::string output_prefix;
+    int shards = 1;
+    ShardFormat format = ShardFormat::Proto;
+    size_t memory_bytes = size_t(1024) * 1024 * 1024;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::string temp_dir;
+    std::vector<std::string> inputs;
+};
+
+static std::string shardPath(const ShuffleOptions& options, int shard) {
+    std::ostringstream name;
+    name << options.output_prefix << "-" << std::setw(5) << std::setfill('0') << shard
+        << "-of-" << std::setw(5) << std::setfill('0') << options.shards;
+    if (options.format == ShardFormat::Proto || options.format == ShardFormat::Chunked) name << ".bin";
+    return name.str();
+}
+
+// Appends size-delimited records to a temporary bucket file; shared by the scatter threads.
+class BucketFile {
+public:
+    explicit BucketFile(const std::string& path) : path(path) {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            throw std::runtime_error("Could not create temporary bucket " + path);
+        }
+    }
+    ~BucketFile() {
+        if (file) std::fclose(file);
+    }
+
+    void append(const std::string& bytes, uint64_t count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (std::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size()) {
+            throw std::runtime_error("Failed to write temporary bucket " + path + " (disk full?)");
+        }
+        records += count;
+    }
+
+    void close() {
+        if (file && std::fclose(file) != 0) {
+            file = nullptr;
+            throw std::runtime_error("Failed to write temporary bucket " + path);
+        }
+        file = nullptr;
+    }
+
+    const std::string path;
+    uint64_t records = 0;
+
+private:
+    std::mutex mutex;
+    std::FILE* file = nullptr;
+};
+
+// Per-thread staging for the scatter pass, so bucket locks are taken once per buffer.
+struct BucketBuffer {
+    std::string bytes;
+    uint64_t count = 0;
+};
+
+static uint64_t estimatedProtoBytes(const std::vector<std::string>& inputs) {
+    double total = 0;
+    std::error_code ec;
+    for (const std::string& path : inputs) {
+        uintmax_t size = fs::file_size(path, ec);
+        if (ec) continue;
+        if (CompactReader::isCompactFile(path)) {
+            uintmax_t policy_size = fs::file_size(CompactWriter::policyPath(path), ec);
+            total += (static_cast<double>(size) + (ec ? 0.0 : static_cast<double>(policy_size))) * kCompactExpansion;
+        }
+        else {
+            total += static_cast<double>(size);
+        }
+    }
+    return static_cast<uint64_t>(total);
+}
+
+// One unit of scatter work: a whole file, or a byte range of a chunked file.
+struct ScatterTask {
+    size_t input;
+    bool chunked;
+    uint64_t begin;
+    uint64_t end;
+};
+
+static std::vector<ScatterTask> planScatter(const ShuffleOptions& options) {
+    std::vector<ScatterTask> tasks;
+    for (size_t i = 0; i < options.inputs.size(); ++i) {
+        const std::string& path = options.inputs[i];
+        std::error_code ec;
+        uint64_t size = fs::file_size(path, ec);
+        if (ec || !ChunkedReader::isChunkedFile(path)) {
+            tasks.push_back({ i, false, 0, 0 });
+            continue;
+        }
+        // Chunked files split at chunk boundaries, so large ones are read by several threads.
+        uint64_t pieces = std::clamp<uint64_t>(size / kMinChunkedSplit, 1, static_cast<uint64_t>(options.threads));
+        for (uint64_t p = 0; p < pieces; ++p) {
+            tasks.push_back({ i, true, size * p / pieces, size * (p + 1) / pieces });
+        }
+    }
+    return tasks;
+}
+
+static bool scatter(const ShuffleOptions& options, std::vector<std::unique_ptr<BucketFile>>& buckets, uint64_t& scattered) {
+    const std::vector<ScatterTask> tasks = planScatter(options);
+    std::vector<std::atomic<uint64_t>> per_input(options.inputs.size());
+    for (auto& count : per_input) count.store(0);
+    std::atomic<size_t> next_task{0};
+    std::atomic<bool> failed{false};
+    std::mutex console_mutex;
+    size_t buffer_limit = options.memory_bytes / (4 * static_cast<size_t>(options.threads) * buckets.size());
+    buffer_limit = std::clamp(buffer_limit, kMinBucketBuffer, kMaxBucketBuffer);
+
+    auto worker = [&]() {
+        std::mt19937_64 rng(std::random_device{}());
+        std::uniform_int_distribution<size_t> pick(0, buckets.size() - 1);
+        std::vector<BucketBuffer> staged(buckets.size());
+        std::string record;
+        auto stage = [&](const std::string& bytes) {
+            size_t b = pick(rng);
+            int32_t size = static_cast<int32_t>(bytes.size());
+            staged[b].bytes.append(reinterpret_cast<const char*>(&size), sizeof(size));
+            staged[b].bytes.append(bytes);
+            staged[b].count++;
+            if (staged[b].bytes.size() >= buffer_limit) {
+                buckets[b]->append(staged[b].bytes, staged[b].count);
+                staged[b].bytes.clear();
+                staged[b].count = 0;
+            }
+        };
+        try {
+            size_t t;
+            while (!failed.load(std::memory_order_relaxed) && (t = next_task.fetch_add(1)) < tasks.size()) {
+                const ScatterTask& task = tasks[t];
+                const std::string& path = options.inputs[task.input];
+                uint64_t read = 0;
+                std::string warning;
+                if (task.chunked) {
+                    ChunkedReader reader(path, task.begin, task.end);
+                    while (reader.next(record)) {
+                        stage(record);
+                        read++;
+                    }
+                    if (reader.stats().damaged_chunks > 0) {
+                        warning = path + ": skipped " + std::to_string(reader.stats().damaged_chunks) + " damaged chunk(s).";
+                    }
+                }
+                else {
+                    SampleReader reader(path);
+                    while (reader.nextSerialized(record)) {
+                        stage(record);
+                        read++;
+                    }
+                    warning = reader.warning();
+                }
+                per_input[task.input] += read;
+                if (!warning.empty()) {
+                    std::lock_guard<std::mutex> lock(console_mutex);
+                    std::cerr << "Warning: " << warning << std::endl;
+                }
+            }
+            for (size_t b = 0; b < staged.size(); ++b) {
+                if (staged[b].count > 0) buckets[b]->append(staged[b].bytes, staged[b].count);
+            }
+        }
+        catch (const std::exception& e) {
+            failed = true;
+            std::lock_guard<std::mutex> lock(console_mutex);
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < options.threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : pool) {
+        t.join();
+    }
+    for (auto& bucket : buckets) {
+        bucket->close();
+    }
+    scattered = 0;
+    for (size_t i = 0; i < options.inputs.size(); ++i) {
+        std::cout << options.inputs[i] << ": " << per_input[i].load() << " samples" << std::endl;
+        scattered += per_input[i].load();
+    }
+    return !failed.load();
+}
+
+static bool loadBucket(const std::string& path, std::vector<std::string>& records) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    bool ok = true;
+    int32_t size = 0;
+    while (std::fread(&size, sizeof(size), 1, file) == 1) {
+        if (size < 0) {
+            ok = false;
+            break;
+        }
+        std::string record(static_cast<size_t>(size), '\0');
+        if (size > 0 && std::fread(&record[0], 1, record.size(), file) != record.size()) {
+            ok = false;
+            break;
+        }
+        records.push_back(std::move(record));
+    }
+    std::fclose(file);
+    return ok;
+}
+
+static bool gather(const ShuffleOptions& options, const std::vector<std::unique_ptr<BucketFile>>& buckets,
+                   std::vector<std::shared_ptr<ISampleWriter>>& shards, uint64_t total) {
+    // Global position of each bucket's first record in the concatenated permutation
+    std::vector<uint64_t> first(buckets.size() + 1, 0);
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        first[b + 1] = first[b] + buckets[b]->records;
+    }
+    const uint64_t shard_count = static_cast<uint64_t>(shards.size());
+    auto shardOf = [&](uint64_t position) { return static_cast<size_t>(position * shard_count / total); };
+
+    std::atomic<size_t> next_bucket{0};
+    std::atomic<bool> failed{false};
+    std::mutex console_mutex;
+
+    auto worker = [&]() {
+        std::mt19937_64 rng(std::random_device{}());
+        std::vector<std::string> records;
+        std::vector<TrainingSample> batch;
+        try {
+            size_t b;
+            while (!failed.load(std::memory_order_relaxed) && (b = next_bucket.fetch_add(1)) < buckets.size()) {
+                records.clear();
+                if (!loadBucket(buckets[b]->path, records) || records.size() != buckets[b]->records) {
+                    throw std::runtime_error("Temporary bucket " + buckets[b]->path + " did not read back intact.");
+                }
+                std::shuffle(records.begin(), records.end(), rng);
+
+                uint64_t position = first[b];
+                size_t i = 0;
+                while (i < records.size()) {
+                    // A run of consecutive positions that all belong to the same shard
+                    size_t shard = shardOf(position);
+                    size_t n = std::min(records.size() - i, kWriteBatch);
+                    while (n > 1 && shardOf(position + n - 1) != shard) n--;
+                    batch.resize(n);
+                    for (size_t k = 0; k < n; ++k) {
+                        if (!batch[k].ParseFromString(records[i + k])) {
+                            throw std::runtime_error("Corrupt record in temporary bucket " + buckets[b]->path);
+                        }
+                    }
+                    shards[shard]->writeGame(batch);
+                    i += n;
+                    position += n;
+                }
+                std::error_code ec;
+                fs::remove(buckets[b]->path, ec);
+            }
+        }
+        catch (const std::exception& e) {
+            failed = true;
+            std::lock_guard<std::mutex> lock(console_mutex);
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < options.threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : pool) {
+        t.join();
+    }
+    return !failed.load();
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " --output-prefix <prefix> --shards <n> [options] <input> [more inputs...]\n";
+    std::cerr << "Shuffles every sample of the inputs (.bin Protobuf streams, chunked or compact files) across\n";
+    std::cerr << "<prefix>-00000-of-0000n ... shards of equal size, using bounded memory.\n";
+    std::cerr << "  --output-format <proto|columnar|compact|chunked> : Shard format (default proto; proto and chunked shards are .bin files).\n";
+    std::cerr << "  --memory-mb <n>    : Memory budget for the in-memory shuffle of all threads together (default 1024).\n";
+    std::cerr << "  --threads <n>      : Worker threads for both passes (default: hardware concurrency).\n";
+    std::cerr << "  --temp-dir <dir>   : Where the temporary buckets go (default: next to the output, removed afterwards).\n";
+    std::cerr << "                       Needs free space for about one extra copy of the dataset in Protobuf form.\n";
+}
+
+int main(int argc, char* argv[]) {
+    ShuffleOptions options;
+    std::string format = "proto";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--output-prefix" && i + 1 < argc) {
+            options.output_prefix = argv[++i];
+        }
+        else if (arg == "--shards" && i + 1 < argc) {
+            options.shards = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--output-format" && i + 1 < argc) {
+            format = argv[++i];
+        }
+        else if (arg == "--memory-mb" && i + 1 < argc) {
+            options.memory_bytes = static_cast<size_t>(std::max(16, std::stoi(argv[++i]))) * 1024 * 1024;
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--temp-dir" && i + 1 < argc) {
+            options.temp_dir = argv[++i];
+        }
+        else {
+            options.inputs.push_back(arg);
+        }
+    }
+    if (format == "proto") options.format = ShardFormat::Proto;
+    else if (format == "columnar") options.format = ShardFormat::Columnar;
+    else if (format == "compact") options.format = ShardFormat::Compact;
+    else if (format == "chunked") options.format = ShardFormat::Chunked;
+    else {
+        std::cerr << "Error: Unknown --output-format '" << format << "'.\n";
+        return 1;
+    }
+    if (options.output_prefix.empty() || options.inputs.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Every writer appends, so shuffling into existing shards would mix old and new data.
+    for (int s = 0; s < options.shards; ++s) {
+        if (fs::exists(shardPath(options, s))) {
+            std::cerr << "Error: " << shardPath(options, s) << " already exists.\n";
+            return 1;
+        }
+    }
+
+    fs::path temp_dir;
+    try {
+        fs::path prefix_dir = fs::path(options.output_prefix).parent_path();
+        if (!prefix_dir.empty()) fs::create_directories(prefix_dir);
+        fs::path temp_root = options.temp_dir.empty() ? (prefix_dir.empty() ? fs::path(".") : prefix_dir) : fs::path(options.temp_dir);
+        temp_dir = temp_root / ("shuffle-tmp-" + std::to_string(std::random_device{}()));
+        fs::create_directories(temp_dir);
+
+        // Each gather thread holds one whole bucket, so size buckets to a thread's share.
+        uint64_t estimate = estimatedProtoBytes(options.inputs);
+        double per_thread = static_cast<double>(options.memory_bytes) / options.threads;
+        size_t bucket_count = static_cast<size_t>(std::ceil(estimate * kInMemoryOverhead / per_thread));
+        bucket_count = std::max<size_t>(bucket_count, static_cast<size_t>(options.threads));
+
+        std::vector<std::unique_ptr<BucketFile>> buckets;
+        for (size_t b = 0; b < bucket_count; ++b) {
+            buckets.push_back(std::make_unique<BucketFile>((temp_dir / ("bucket-" + std::to_string(b) + ".tmp")).string()));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t total = 0;
+        if (!scatter(options, buckets, total)) {
+            throw std::runtime_error("Scatter pass failed.");
+        }
+        double scatter_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Scattered " << total << " samples into " << bucket_count << " buckets in " << scatter_sec << " s." << std::endl;
+
+        std::vector<std::shared_ptr<ISampleWriter>> shards;
+        DataWriterOptions writerOptions;
+        writerOptions.queue_capacity = 16; // Batches are small and every shard has its own queue
+        for (int s = 0; s < options.shards; ++s) {
+            std::string path = shardPath(options, s);
+            if (options.format == ShardFormat::Compact) shards.push_back(std::make_shared<CompactWriter>(path));
+            else if (options.format == ShardFormat::Columnar) shards.push_back(std::make_shared<ColumnarWriter>(path));
+            else if (options.format == ShardFormat::Chunked) shards.push_back(std::make_shared<ChunkedWriter>(path));
+            else shards.push_back(std::make_shared<DataWriter>(path, writerOptions));
+        }
+        if (total > 0 && !gather(options, buckets, shards, total)) {
+            throw std::runtime_error("Gather pass failed.");
+        }
+        for (auto& shard : shards) {
+            shard->close();
+        }
+        fs::remove_all(temp_dir);
+
+        double elapsed_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Wrote " << total << " samples to " << options.shards << " shards (" << total / options.shards
+            << (total % options.shards ? "-" + std::to_string(total / options.shards + 1) : std::string())
+            << " each) in " << elapsed_sec << " s: " << shardPath(options, 0);
+        if (options.shards > 1) std::cout << " ... " << shardPath(options, options.shards - 1);
+        std::cout << std::endl;
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "FATAL: " << e.what() << std::endl;
+        std::error_code ec;
+        if (!temp_dir.empty()) fs::remove_all(temp_dir, ec);
+        return 1;
+    }
+}
@@ -36,10 +36,14 @@ void runSimulationMode() {
             for (int i = 0; i < 4; ++i) {
                 UI::printTurnInfo(state);
 
-                if (GameLogic::canTram(state)) {
-                    std::cout << "Player " << state.currentPlayerIndex + 1 << " has TRAM." << std::endl;
-                    int remainingTricks = 13 - trick;
-                    state.players[state.currentPlayerIndex].tricksWon += remainingTricks;
+                std::array<int, 4> claimed;
+                if (GameLogic::findClaim(state, claimed)) {
+                    for (int p = 0; p < 4; ++p) {
+                        if (claimed[p] > 0) {
+                            std::cout << "Player " << p + 1 << " claims " << claimed[p] << " trick(s)." << std::endl;
+                        }
+                    }
+                    GameLogic::applyClaim(state, claimed);
                     goto end_of_round;
                 }
 
@@ -110,9 +114,9 @@ void runDataGenerationMode(int numGames, const std::string& outputFile) {
             for (int trick = 0; trick < 13; ++trick) {
                 state.currentTrick.clear();
                 for (int turn = 0; turn < 4; ++turn) {
-                    if (GameLogic::canTram(state)) {
-                        int remainingTricks = 13 - trick;
-                        state.players[state.currentPlayerIndex].tricksWon += remainingTricks;
+                    std::array<int, 4> claimed;
+                    if (GameLogic::findClaim(state, claimed)) {
+                        GameLogic::applyClaim(state, claimed);
                         goto end_of_round_data;
                     }
                     auto validMoves = GameLogic::getValidMoves(state);
@@ -29,10 +29,15 @@ inline constexpr TrainingSample::Impl_::Impl_(
     ::_pbi::ConstantInitialized) noexcept
       : state_features_{},
         policy_target_{},
-        is_bidding_{false},
         player_idx_{0},
         value_target_{0},
         actual_game_win_value_{0},
+        is_bidding_{false},
+        fast_search_{false},
+        model_generation_{0},
+        feature_version_{0},
+        visit_total_{0},
+        sampling_rate_{0},
         _cached_size_{0} {}
 
 template <typename>
@@ -75,6 +80,11 @@ const ::uint32_t
         PROTOBUF_FIELD_OFFSET(::TrainingSample, _impl_.policy_target_),
         PROTOBUF_FIELD_OFFSET(::TrainingSample, _impl_.value_target_),
         PROTOBUF_FIELD_OFFSET(::TrainingSample, _impl_.actual_game_win_value_),
+        PROTOBUF_FIELD_OFFSET(::TrainingSample, _impl_.model_generation_),
+        PROTOBUF_FIELD_OFFSET(::TrainingSample, _impl_.feature_version_),
+        PROTOBUF_FIELD_OFFSET(::TrainingSample, _impl_.visit_total_),
+        PROTOBUF_FIELD_OFFSET(::TrainingSample, _impl_.sampling_rate_),
+        PROTOBUF_FIELD_OFFSET(::TrainingSample, _impl_.fast_search_),
 };
 
 static const ::_pbi::MigrationSchema
@@ -86,17 +96,20 @@ static const ::_pb::Message* const file_default_instances[] = {
 };
 const char descriptor_table_protodef_test_2eproto[] ABSL_ATTRIBUTE_SECTION_VARIABLE(
     protodesc_cold) = {
-    "\n\ntest.proto\"\234\001\n\016TrainingSample\022\022\n\nis_bi"
+    "\n\ntest.proto\"\220\002\n\016TrainingSample\022\022\n\nis_bi"
     "dding\030\001 \001(\010\022\022\n\nplayer_idx\030\002 \001(\005\022\026\n\016state"
     "_features\030\003 \003(\002\022\025\n\rpolicy_target\030\004 \003(\002\022\024"
     "\n\014value_target\030\005 \001(\002\022\035\n\025actual_game_win_"
-    "value\030\006 \001(\002b\006proto3"
+    "value\030\006 \001(\002\022\030\n\020model_generation\030\007 \001(\005\022\027\n"
+    "\017feature_version\030\010 \001(\005\022\023\n\013visit_total\030\t "
+    "\001(\005\022\025\n\rsampling_rate\030\n \001(\002\022\023\n\013fast_searc"
+    "h\030\013 \001(\010b\006proto3"
 };
 static ::absl::once_flag descriptor_table_test_2eproto_once;
 PROTOBUF_CONSTINIT const ::_pbi::DescriptorTable descriptor_table_test_2eproto = {
     false,
     false,
-    179,
+    295,
     descriptor_table_protodef_test_2eproto,
     "test.proto",
     &descriptor_table_test_2eproto_once,
@@ -145,12 +158,12 @@ TrainingSample::TrainingSample(
       from._internal_metadata_);
   new (&_impl_) Impl_(internal_visibility(), arena, from._impl_, from);
   ::memcpy(reinterpret_cast<char *>(&_impl_) +
-               offsetof(Impl_, is_bidding_),
+               offsetof(Impl_, player_idx_),
            reinterpret_cast<const char *>(&from._impl_) +
-               offsetof(Impl_, is_bidding_),
-           offsetof(Impl_, actual_game_win_value_) -
-               offsetof(Impl_, is_bidding_) +
-               sizeof(Impl_::actual_game_win_value_));
+               offsetof(Impl_, player_idx_),
+           offsetof(Impl_, sampling_rate_) -
+               offsetof(Impl_, player_idx_) +
+               sizeof(Impl_::sampling_rate_));
 
   // @@protoc_insertion_point(copy_constructor:TrainingSample)
 }
@@ -164,11 +177,11 @@ inline PROTOBUF_NDEBUG_INLINE TrainingSample::Impl_::Impl_(
 inline void TrainingSample::SharedCtor(::_pb::Arena* arena) {
   new (&_impl_) Impl_(internal_visibility(), arena);
   ::memset(reinterpret_cast<char *>(&_impl_) +
-               offsetof(Impl_, is_bidding_),
+               offsetof(Impl_, player_idx_),
            0,
-           offsetof(Impl_, actual_game_win_value_) -
-               offsetof(Impl_, is_bidding_) +
-               sizeof(Impl_::actual_game_win_value_));
+           offsetof(Impl_, sampling_rate_) -
+               offsetof(Impl_, player_idx_) +
+               sizeof(Impl_::sampling_rate_));
 }
 TrainingSample::~TrainingSample() {
   // @@protoc_insertion_point(destructor:TrainingSample)
@@ -233,15 +246,15 @@ const ::google::protobuf::internal::ClassData* TrainingSample::GetClassData() co
   return _class_data_.base();
 }
 PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1
-const ::_pbi::TcParseTable<3, 6, 0, 0, 2> TrainingSample::_table_ = {
+const ::_pbi::TcParseTable<4, 11, 0, 0, 2> TrainingSample::_table_ = {
   {
     0,  // no _has_bits_
     0, // no _extensions_
-    6, 56,  // max_field_number, fast_idx_mask
+    11, 120,  // max_field_number, fast_idx_mask
     offsetof(decltype(_table_), field_lookup_table),
-    4294967232,  // skipmap
+    4294965248,  // skipmap
     offsetof(decltype(_table_), field_entries),
-    6,  // num_field_entries
+    11,  // num_field_entries
     0,  // num_aux_entries
     offsetof(decltype(_table_), field_names),  // no aux_entries
     _class_data_.base(),
@@ -270,6 +283,24 @@ const ::_pbi::TcParseTable<3, 6, 0, 0, 2> TrainingSample::_table_ = {
     // float actual_game_win_value = 6;
     {::_pbi::TcParser::FastF32S1,
      {53, 63, 0, PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.actual_game_win_value_)}},
+    // int32 model_generation = 7;
+    {::_pbi::TcParser::SingularVarintNoZag1<::uint32_t, offsetof(TrainingSample, _impl_.model_generation_), 63>(),
+     {56, 63, 0, PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.model_generation_)}},
+    // int32 feature_version = 8;
+    {::_pbi::TcParser::SingularVarintNoZag1<::uint32_t, offsetof(TrainingSample, _impl_.feature_version_), 63>(),
+     {64, 63, 0, PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.feature_version_)}},
+    // int32 visit_total = 9;
+    {::_pbi::TcParser::SingularVarintNoZag1<::uint32_t, offsetof(TrainingSample, _impl_.visit_total_), 63>(),
+     {72, 63, 0, PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.visit_total_)}},
+    // float sampling_rate = 10;
+    {::_pbi::TcParser::FastF32S1,
+     {85, 63, 0, PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.sampling_rate_)}},
+    // bool fast_search = 11;
+    {::_pbi::TcParser::SingularVarintNoZag1<bool, offsetof(TrainingSample, _impl_.fast_search_), 63>(),
+     {88, 63, 0, PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.fast_search_)}},
+    {::_pbi::TcParser::MiniParse, {}},
+    {::_pbi::TcParser::MiniParse, {}},
+    {::_pbi::TcParser::MiniParse, {}},
     {::_pbi::TcParser::MiniParse, {}},
   }}, {{
     65535, 65535
@@ -292,6 +323,21 @@ const ::_pbi::TcParseTable<3, 6, 0, 0, 2> TrainingSample::_table_ = {
     // float actual_game_win_value = 6;
     {PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.actual_game_win_value_), 0, 0,
     (0 | ::_fl::kFcSingular | ::_fl::kFloat)},
+    // int32 model_generation = 7;
+    {PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.model_generation_), 0, 0,
+    (0 | ::_fl::kFcSingular | ::_fl::kInt32)},
+    // int32 feature_version = 8;
+    {PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.feature_version_), 0, 0,
+    (0 | ::_fl::kFcSingular | ::_fl::kInt32)},
+    // int32 visit_total = 9;
+    {PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.visit_total_), 0, 0,
+    (0 | ::_fl::kFcSingular | ::_fl::kInt32)},
+    // float sampling_rate = 10;
+    {PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.sampling_rate_), 0, 0,
+    (0 | ::_fl::kFcSingular | ::_fl::kFloat)},
+    // bool fast_search = 11;
+    {PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.fast_search_), 0, 0,
+    (0 | ::_fl::kFcSingular | ::_fl::kBool)},
   }},
   // no aux_entries
   {{
@@ -307,9 +353,9 @@ PROTOBUF_NOINLINE void TrainingSample::Clear() {
 
   _impl_.state_features_.Clear();
   _impl_.policy_target_.Clear();
-  ::memset(&_impl_.is_bidding_, 0, static_cast<::size_t>(
-      reinterpret_cast<char*>(&_impl_.actual_game_win_value_) -
-      reinterpret_cast<char*>(&_impl_.is_bidding_)) + sizeof(_impl_.actual_game_win_value_));
+  ::memset(&_impl_.player_idx_, 0, static_cast<::size_t>(
+      reinterpret_cast<char*>(&_impl_.sampling_rate_) -
+      reinterpret_cast<char*>(&_impl_.player_idx_)) + sizeof(_impl_.sampling_rate_));
   _internal_metadata_.Clear<::google::protobuf::UnknownFieldSet>();
 }
 
@@ -366,6 +412,41 @@ PROTOBUF_NOINLINE void TrainingSample::Clear() {
                 6, this_._internal_actual_game_win_value(), target);
           }
 
+          // int32 model_generation = 7;
+          if (this_._internal_model_generation() != 0) {
+            target = ::google::protobuf::internal::WireFormatLite::
+                WriteInt32ToArrayWithField<7>(
+                    stream, this_._internal_model_generation(), target);
+          }
+
+          // int32 feature_version = 8;
+          if (this_._internal_feature_version() != 0) {
+            target = ::google::protobuf::internal::WireFormatLite::
+                WriteInt32ToArrayWithField<8>(
+                    stream, this_._internal_feature_version(), target);
+          }
+
+          // int32 visit_total = 9;
+          if (this_._internal_visit_total() != 0) {
+            target = ::google::protobuf::internal::WireFormatLite::
+                WriteInt32ToArrayWithField<9>(
+                    stream, this_._internal_visit_total(), target);
+          }
+
+          // float sampling_rate = 10;
+          if (::absl::bit_cast<::uint32_t>(this_._internal_sampling_rate()) != 0) {
+            target = stream->EnsureSpace(target);
+            target = ::_pbi::WireFormatLite::WriteFloatToArray(
+                10, this_._internal_sampling_rate(), target);
+          }
+
+          // bool fast_search = 11;
+          if (this_._internal_fast_search() != 0) {
+            target = stream->EnsureSpace(target);
+            target = ::_pbi::WireFormatLite::WriteBoolToArray(
+                11, this_._internal_fast_search(), target);
+          }
+
           if (PROTOBUF_PREDICT_FALSE(this_._internal_metadata_.have_unknown_fields())) {
             target =
                 ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
@@ -413,10 +494,6 @@ PROTOBUF_NOINLINE void TrainingSample::Clear() {
             }
           }
            {
-            // bool is_bidding = 1;
-            if (this_._internal_is_bidding() != 0) {
-              total_size += 2;
-            }
             // int32 player_idx = 2;
             if (this_._internal_player_idx() != 0) {
               total_size += ::_pbi::WireFormatLite::Int32SizePlusOne(
@@ -430,6 +507,33 @@ PROTOBUF_NOINLINE void TrainingSample::Clear() {
             if (::absl::bit_cast<::uint32_t>(this_._internal_actual_game_win_value()) != 0) {
               total_size += 5;
             }
+            // bool is_bidding = 1;
+            if (this_._internal_is_bidding() != 0) {
+              total_size += 2;
+            }
+            // bool fast_search = 11;
+            if (this_._internal_fast_search() != 0) {
+              total_size += 2;
+            }
+            // int32 model_generation = 7;
+            if (this_._internal_model_generation() != 0) {
+              total_size += ::_pbi::WireFormatLite::Int32SizePlusOne(
+                  this_._internal_model_generation());
+            }
+            // int32 feature_version = 8;
+            if (this_._internal_feature_version() != 0) {
+              total_size += ::_pbi::WireFormatLite::Int32SizePlusOne(
+                  this_._internal_feature_version());
+            }
+            // int32 visit_total = 9;
+            if (this_._internal_visit_total() != 0) {
+              total_size += ::_pbi::WireFormatLite::Int32SizePlusOne(
+                  this_._internal_visit_total());
+            }
+            // float sampling_rate = 10;
+            if (::absl::bit_cast<::uint32_t>(this_._internal_sampling_rate()) != 0) {
+              total_size += 5;
+            }
           }
           return this_.MaybeComputeUnknownFieldsSize(total_size,
                                                      &this_._impl_._cached_size_);
@@ -445,9 +549,6 @@ void TrainingSample::MergeImpl(::google::protobuf::MessageLite& to_msg, const ::
 
   _this->_internal_mutable_state_features()->MergeFrom(from._internal_state_features());
   _this->_internal_mutable_policy_target()->MergeFrom(from._internal_policy_target());
-  if (from._internal_is_bidding() != 0) {
-    _this->_impl_.is_bidding_ = from._impl_.is_bidding_;
-  }
   if (from._internal_player_idx() != 0) {
     _this->_impl_.player_idx_ = from._impl_.player_idx_;
   }
@@ -457,6 +558,24 @@ void TrainingSample::MergeImpl(::google::protobuf::MessageLite& to_msg, const ::
   if (::absl::bit_cast<::uint32_t>(from._internal_actual_game_win_value()) != 0) {
     _this->_impl_.actual_game_win_value_ = from._impl_.actual_game_win_value_;
   }
+  if (from._internal_is_bidding() != 0) {
+    _this->_impl_.is_bidding_ = from._impl_.is_bidding_;
+  }
+  if (from._internal_fast_search() != 0) {
+    _this->_impl_.fast_search_ = from._impl_.fast_search_;
+  }
+  if (from._internal_model_generation() != 0) {
+    _this->_impl_.model_generation_ = from._impl_.model_generation_;
+  }
+  if (from._internal_feature_version() != 0) {
+    _this->_impl_.feature_version_ = from._impl_.feature_version_;
+  }
+  if (from._internal_visit_total() != 0) {
+    _this->_impl_.visit_total_ = from._impl_.visit_total_;
+  }
+  if (::absl::bit_cast<::uint32_t>(from._internal_sampling_rate()) != 0) {
+    _this->_impl_.sampling_rate_ = from._impl_.sampling_rate_;
+  }
   _this->_internal_metadata_.MergeFrom<::google::protobuf::UnknownFieldSet>(from._internal_metadata_);
 }
 
@@ -474,11 +593,11 @@ void TrainingSample::InternalSwap(TrainingSample* PROTOBUF_RESTRICT other) {
   _impl_.state_features_.InternalSwap(&other->_impl_.state_features_);
   _impl_.policy_target_.InternalSwap(&other->_impl_.policy_target_);
   ::google::protobuf::internal::memswap<
-      PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.actual_game_win_value_)
-      + sizeof(TrainingSample::_impl_.actual_game_win_value_)
-      - PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.is_bidding_)>(
-          reinterpret_cast<char*>(&_impl_.is_bidding_),
-          reinterpret_cast<char*>(&other->_impl_.is_bidding_));
+      PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.sampling_rate_)
+      + sizeof(TrainingSample::_impl_.sampling_rate_)
+      - PROTOBUF_FIELD_OFFSET(TrainingSample, _impl_.player_idx_)>(
+          reinterpret_cast<char*>(&_impl_.player_idx_),
+          reinterpret_cast<char*>(&other->_impl_.player_idx_));
 }
 
 ::google::protobuf::Metadata TrainingSample::GetMetadata() const {
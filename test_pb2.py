@@ -24,7 +24,7 @@ _sym_db = _symbol_database.Default()
 
 
 
-DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\ntest.proto\"\x9c\x01\n\x0eTrainingSample\x12\x12\n\nis_bidding\x18\x01 \x01(\x08\x12\x12\n\nplayer_idx\x18\x02 \x01(\x05\x12\x16\n\x0estate_features\x18\x03 \x03(\x02\x12\x15\n\rpolicy_target\x18\x04 \x03(\x02\x12\x14\n\x0cvalue_target\x18\x05 \x01(\x02\x12\x1d\n\x15\x61\x63tual_game_win_value\x18\x06 \x01(\x02\x62\x06proto3')
+DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\ntest.proto\"\x90\x02\n\x0eTrainingSample\x12\x12\n\nis_bidding\x18\x01 \x01(\x08\x12\x12\n\nplayer_idx\x18\x02 \x01(\x05\x12\x16\n\x0estate_features\x18\x03 \x03(\x02\x12\x15\n\rpolicy_target\x18\x04 \x03(\x02\x12\x14\n\x0cvalue_target\x18\x05 \x01(\x02\x12\x1d\n\x15\x61\x63tual_game_win_value\x18\x06 \x01(\x02\x12\x18\n\x10model_generation\x18\x07 \x01(\x05\x12\x17\n\x0f\x66\x65\x61ture_version\x18\x08 \x01(\x05\x12\x13\n\x0bvisit_total\x18\t \x01(\x05\x12\x15\n\rsampling_rate\x18\n \x01(\x02\x12\x13\n\x0b\x66\x61st_search\x18\x0b \x01(\x08\x62\x06proto3')
 
 _globals = globals()
 _builder.BuildMessageAndEnumDescriptors(DESCRIPTOR, _globals)
@@ -32,5 +32,5 @@ _builder.BuildTopDescriptorsAndMessages(DESCRIPTOR, 'test_pb2', _globals)
 if not _descriptor._USE_C_DESCRIPTORS:
   DESCRIPTOR._loaded_options = None
   _globals['_TRAININGSAMPLE']._serialized_start=15
-  _globals['_TRAININGSAMPLE']._serialized_end=171
+  _globals['_TRAININGSAMPLE']._serialized_end=287
 # @@protoc_insertion_point(module_scope)
@@ -2,8 +2,11 @@ import numpy as np
 import torch
 import torch.nn as nn
 import torch.optim as optim
-from torch.utils.data import TensorDataset, DataLoader
+from torch.utils.data import Dataset, DataLoader, BatchSampler, RandomSampler
 import os
+import json
+import socket
+import struct
 import argparse
 from tqdm import tqdm
 import test_pb2 as pb# Import the generated module
@@ -39,6 +42,31 @@ class PlayingModelNN2(nn.Module):
     def forward(self, x):
         return self.network(x)
 
+class PolicyValueModel(nn.Module):
+    # Two-headed playing model: one shared trunk over the NN2 features feeds a card
+    # policy head and a win-probability head, so MCTS pays one inference per leaf.
+    def __init__(self, input_size=118):
+        super(PolicyValueModel, self).__init__()
+        self.trunk = nn.Sequential(
+            nn.Linear(input_size, 128),
+            nn.ReLU(),
+            nn.Linear(128, 128),
+            nn.ReLU(),
+        )
+        self.policy_head = nn.Sequential(
+            nn.Linear(128, 13), # Max 13 cards in hand
+            nn.Softmax(dim=-1)
+        )
+        self.value_head = nn.Sequential(
+            nn.Linear(128, 32),
+            nn.ReLU(),
+            nn.Linear(32, 1),
+            nn.Sigmoid() # Win probability for the team of the player to move
+        )
+    def forward(self, x):
+        shared = self.trunk(x)
+        return self.policy_head(shared), self.value_head(shared)
+
 # --- NEW, TYPE-SAFE DATA LOADING FUNCTION ---
 def load_training_data_proto(filepath):
     """Loads training data from the size-delimited Protobuf binary format."""
@@ -55,36 +83,315 @@ def load_training_data_proto(filepath):
             # 2. Read the actual message data
             msg_bytes = f.read(size)
             if len(msg_bytes) != size:
+                # Nothing after a torn record can be framed; chunked files recover from this.
                 print("Warning: Incomplete message found at end of file.")
-                continue
+                break
 
             # 3. Parse the message using the generated Protobuf class
-            sample = pb.TrainingSample()
-            sample.ParseFromString(msg_bytes)
-
-            # 4. Extract the data in a 100% type-safe way
-            state_vec = np.array(sample.state_features, dtype=np.float32)
-            policy_vec = np.array(sample.policy_target, dtype=np.float32)
-            
-            # You can choose which value to use for training.
-            # The MCTS value is often better for policy heads.
-            value = sample.value_target
-            
-            # Add to the correct list
-            if sample.is_bidding:
-                # Optional sanity check
-                if state_vec.shape[0] == 8 and policy_vec.shape[0] == 14:
-                    samples['bidding'].append((state_vec, policy_vec, value))
-            else:
-                # Placeholder for playing data
-                pass
+            add_proto_sample(samples, msg_bytes)
+
+    return samples
 
+def add_proto_sample(samples, msg_bytes):
+    """Parses one serialized TrainingSample into the 'bidding' or 'playing' list."""
+    sample = pb.TrainingSample()
+    sample.ParseFromString(msg_bytes)
+
+    # Extract the data in a 100% type-safe way
+    state_vec = np.array(sample.state_features, dtype=np.float32)
+    policy_vec = np.array(sample.policy_target, dtype=np.float32)
+
+    # You can choose which value to use for training.
+    # The MCTS value is often better for policy heads.
+    value = sample.value_target
+
+    # Add to the correct list
+    if sample.is_bidding:
+        # Optional sanity check
+        if state_vec.shape[0] == 8 and policy_vec.shape[0] == 14:
+            samples['bidding'].append((state_vec, policy_vec, value))
+    else:
+        # Policies cover the current hand only; pad to 13 so they stack.
+        if state_vec.shape[0] == 118 and policy_vec.shape[0] <= 13:
+            padded_policy = np.zeros(13, dtype=np.float32)
+            padded_policy[:policy_vec.shape[0]] = policy_vec
+            samples['playing'].append((state_vec, padded_policy, sample.actual_game_win_value))
+
+# Mirrors ChunkHeader in src/include/ChunkedWriter.hpp (self_play --output-format chunked).
+CHUNK_MAGIC = b'SPDCHNK1'
+CHUNK_HEADER = struct.Struct('<8sIIIIII')
+
+try:
+    from crc32c import crc32c
+except ImportError:
+    _CRC32C_TABLE = []
+    for _i in range(256):
+        _c = _i
+        for _ in range(8):
+            _c = (_c >> 1) ^ (0x82F63B78 if _c & 1 else 0)
+        _CRC32C_TABLE.append(_c)
+
+    def crc32c(data):
+        """Pure-Python fallback; `pip install crc32c` is much faster."""
+        crc = 0xFFFFFFFF
+        for b in data:
+            crc = (crc >> 8) ^ _CRC32C_TABLE[(crc ^ b) & 0xFF]
+        return crc ^ 0xFFFFFFFF
+
+def parse_chunk_header(data, pos):
+    """The ChunkHeader fields at `pos`, or None where no valid header starts."""
+    if len(data) - pos < CHUNK_HEADER.size:
+        return None
+    magic, chunk_bytes, payload_bytes, records, payload_crc, _, header_crc = CHUNK_HEADER.unpack_from(data, pos)
+    if magic != CHUNK_MAGIC or crc32c(bytes(data[pos:pos + CHUNK_HEADER.size - 4])) != header_crc:
+        return None
+    if chunk_bytes <= CHUNK_HEADER.size or payload_bytes > chunk_bytes - CHUNK_HEADER.size:
+        return None
+    return chunk_bytes, payload_bytes, records, payload_crc
+
+def is_chunked_file(path):
+    with open(path, 'rb') as f:
+        return parse_chunk_header(f.read(CHUNK_HEADER.size), 0) is not None
+
+def load_training_data_chunked(filepath):
+    """Loads a chunked file, skipping chunks that fail their CRC (torn or damaged writes)."""
+    samples = {'bidding': [], 'playing': []}
+    with open(filepath, 'rb') as f:
+        data = memoryview(f.read())
+    raw = data.obj
+    pos, damaged = 0, 0
+    while pos < len(data):
+        header = parse_chunk_header(data, pos)
+        if header is not None:
+            chunk_bytes, payload_bytes, records, payload_crc = header
+            start = pos + CHUNK_HEADER.size
+            payload = data[start:start + payload_bytes]
+            if pos + chunk_bytes <= len(data) and crc32c(bytes(payload)) == payload_crc:
+                offset = 0
+                for _ in range(records):
+                    size = struct.unpack_from('<i', payload, offset)[0]
+                    add_proto_sample(samples, bytes(payload[offset + 4:offset + 4 + size]))
+                    offset += 4 + size
+                pos += chunk_bytes
+                continue
+            damaged += 1
+        # Resynchronize on the next valid header
+        pos = raw.find(CHUNK_MAGIC, pos + 1)
+        while pos != -1 and parse_chunk_header(data, pos) is None:
+            pos = raw.find(CHUNK_MAGIC, pos + 1)
+        if pos == -1:
+            break
+    if damaged:
+        print(f"Warning: skipped {damaged} damaged chunk(s) in {filepath}.")
     return samples
 
+# Mirrors SampleIndexEntry in src/include/SampleIndex.hpp (<file>.idx, written by self_play or build_index).
+SAMPLE_INDEX_MAGIC = b'SPDIDX1\0'
+SAMPLE_INDEX_DTYPE = np.dtype([('offset', '<u8'), ('game_id', '<u4'), ('is_bidding', 'u1'), ('reserved', 'u1', 3)])
+
+class IndexedProtoFile:
+    """Random access to the records of a size-delimited Protobuf file through its .idx sidecar."""
+    def __init__(self, filepath):
+        with open(filepath + '.idx', 'rb') as f:
+            if f.read(len(SAMPLE_INDEX_MAGIC)) != SAMPLE_INDEX_MAGIC:
+                raise ValueError(f"{filepath}.idx is not a sample index.")
+        self.filepath = filepath
+        self.index = np.memmap(filepath + '.idx', dtype=SAMPLE_INDEX_DTYPE, mode='r', offset=16)
+
+    def __len__(self):
+        return len(self.index)
+
+    def __getitem__(self, i):
+        with open(self.filepath, 'rb') as f:
+            f.seek(int(self.index['offset'][i]))
+            size = np.frombuffer(f.read(4), dtype=np.int32)[0]
+            sample = pb.TrainingSample()
+            sample.ParseFromString(f.read(size))
+            return sample
+
+    def game_aligned_splits(self, n):
+        """Splits the records into n contiguous (start, stop) ranges that never cut a game,
+        e.g. one per parallel loader worker."""
+        game_starts = np.flatnonzero(np.diff(self.index['game_id'], prepend=-1) != 0)
+        targets = np.linspace(0, len(self.index), n + 1)[1:-1]
+        cuts = game_starts[np.minimum(np.searchsorted(game_starts, targets), len(game_starts) - 1)] if len(game_starts) else []
+        bounds = [0] + sorted(set(int(c) for c in cuts)) + [len(self.index)]
+        return list(zip(bounds[:-1], bounds[1:]))
+
+def load_training_data_columnar(dirpath):
+    """Memory-maps a columnar dataset directory (self_play --output-format columnar or
+    convert_data). Nothing is read until a batch touches it, so datasets larger than RAM work."""
+    with open(os.path.join(dirpath, 'manifest.json')) as f:
+        manifest = json.load(f)
+    if manifest.get('format') != 'spades-columnar':
+        raise ValueError(f"{dirpath} is not a spades-columnar dataset.")
+    column = lambda phase, name: np.load(os.path.join(dirpath, phase, f"{name}.npy"), mmap_mode='r')
+    data = {
+        'bidding': (column('bidding', 'features'), column('bidding', 'policy'), column('bidding', 'value')),
+        'playing': (column('playing', 'features'), column('playing', 'policy'), column('playing', 'outcome')),
+    }
+    if os.path.exists(os.path.join(dirpath, 'bidding', 'sampling_rate.npy')):
+        # 0 where the rate was not recorded, meaning every decision was kept
+        rate = lambda phase: np.where(column(phase, 'sampling_rate') > 0, column(phase, 'sampling_rate'), 1.0).astype(np.float32)
+        data['sampling_rate'] = {'bidding': rate('bidding'), 'playing': rate('playing')}
+    if os.path.exists(os.path.join(dirpath, 'bidding', 'fast_search.npy')):
+        data['fast_search'] = {phase: np.asarray(column(phase, 'fast_search')) != 0 for phase in ('bidding', 'playing')}
+    return data
+
+# Mirrors CompactRecord / CompactPolicyEntry in src/include/CompactRecord.hpp.
+COMPACT_MAGIC = b'SPDCMP1\0'
+COMPACT_HEADER_BYTES = 16
+COMPACT_RECORD_DTYPE = np.dtype([
+    ('hand_mask', '<u8'), ('trick_mask', '<u8'), ('value_target', '<f4'), ('outcome', '<f4'),
+    ('scores', '<i2', 2), ('bags', '<i2', 2), ('model_generation', '<u2'), ('bids', 'i1', 4),
+    ('tricks_won', 'u1', 4), ('flags', 'u1'), ('player_idx', 'u1'), ('current_player', 'u1'),
+    ('policy_entries', 'u1'), ('feature_version', 'u1'), ('sampling_rate', 'u1'),
+])
+COMPACT_POLICY_DTYPE = np.dtype([('action', 'u1'), ('count', '<u2')])
+COMPACT_BIDDING, COMPACT_SPADES_BROKEN, COMPACT_FAST_SEARCH = 1, 2, 8
+COMPACT_SAMPLING_RATE_STEPS = 16.0  # kCompactSamplingRateSteps: log2 steps per halving
+
+def is_compact_file(path):
+    with open(path, 'rb') as f:
+        return f.read(len(COMPACT_MAGIC)) == COMPACT_MAGIC
+
+def expand_card_masks(masks):
+    """(N,) uint64 card masks -> (N, 52) float32 multi-hot rows (bit = suit * 13 + rank)."""
+    bits = np.unpackbits(np.ascontiguousarray(masks, dtype='<u8').view(np.uint8).reshape(-1, 8), axis=1, bitorder='little')
+    return bits[:, :52].astype(np.float32)
+
+def load_training_data_compact(path):
+    """Expands a bit-packed dataset (self_play --output-format compact) into the training
+    tensors. Records and policy entries are memory-mapped; only the dense result is in memory."""
+    # Whole items only: an interrupted write can leave a partial one at the end of either file.
+    n_records = (os.path.getsize(path) - COMPACT_HEADER_BYTES) // COMPACT_RECORD_DTYPE.itemsize
+    records = np.memmap(path, dtype=COMPACT_RECORD_DTYPE, mode='r', offset=COMPACT_HEADER_BYTES, shape=(n_records,)) if n_records > 0 else np.zeros(0, COMPACT_RECORD_DTYPE)
+    policy_path = path + '.policy'
+    n_entries = os.path.getsize(policy_path) // COMPACT_POLICY_DTYPE.itemsize
+    entries = np.memmap(policy_path, dtype=COMPACT_POLICY_DTYPE, mode='r', shape=(n_entries,)) if n_entries > 0 else np.zeros(0, COMPACT_POLICY_DTYPE)
+    # Drop a tail whose policy entries never made it to disk.
+    ends = np.cumsum(records['policy_entries'], dtype=np.int64)
+    records = records[:np.searchsorted(ends, len(entries), side='right')]
+    return expand_compact(records, entries)
+
+def expand_compact(records, entries):
+    """Compact records plus their policy entries (in record order) -> training tensors."""
+    # Sparse (action, count) lists -> dense rows normalized by each record's total count.
+    owner = np.repeat(np.arange(len(records)), records['policy_entries'])
+    used = entries[:len(owner)]
+    policy = np.zeros((len(records), 14), dtype=np.float32)
+    np.add.at(policy, (owner, used['action'].astype(np.int64)), used['count'].astype(np.float32))
+    totals = policy.sum(axis=1, keepdims=True)
+    policy = np.divide(policy, totals, out=np.zeros_like(policy), where=totals > 0)
+
+    prefix = np.concatenate([records['scores'], records['bags'], records['bids']], axis=1).astype(np.float32)
+    bidding = (records['flags'] & COMPACT_BIDDING) != 0
+    play = records[~bidding]
+    play_features = np.concatenate([
+        prefix[~bidding],
+        expand_card_masks(play['hand_mask']),
+        expand_card_masks(play['trick_mask']),
+        play['tricks_won'].astype(np.float32),
+        ((play['flags'] & COMPACT_SPADES_BROKEN) != 0).astype(np.float32)[:, None],
+        play['current_player'].astype(np.float32)[:, None],
+    ], axis=1)
+    # TrainingSample.sampling_rate: the chance each sample had of being kept (1 = all were)
+    rate = np.exp2(-records['sampling_rate'].astype(np.float32) / COMPACT_SAMPLING_RATE_STEPS)
+    fast = (records['flags'] & COMPACT_FAST_SEARCH) != 0
+    return {
+        'bidding': (prefix[bidding], policy[bidding], np.array(records['value_target'][bidding])),
+        'playing': (play_features, policy[~bidding, :13], np.array(play['outcome'])),
+        'sampling_rate': {'bidding': rate[bidding], 'playing': rate[~bidding]},
+        # TrainingSample.fast_search: policy targets from the reduced budget (--record-fast-searches)
+        'fast_search': {'bidding': fast[bidding], 'playing': fast[~bidding]},
+    }
+
+# Mirrors the request/response layout in src/include/ReplayServer.hpp.
+REPLAY_MODES = {'uniform': 0, 'recency': 1}
+REPLAY_MAX_BATCH = 1 << 16
+
+class ReplayBufferClient:
+    """Pulls minibatches from a running self_play --replay-port replay buffer."""
+    def __init__(self, endpoint):
+        host, port = endpoint.rsplit(':', 1)
+        self.sock = socket.create_connection((host, int(port)))
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+
+    def _recv(self, size):
+        data = bytearray(size)
+        view = memoryview(data)
+        while view:
+            n = self.sock.recv_into(view)
+            if n == 0:
+                raise ConnectionError("Replay buffer closed the connection.")
+            view = view[n:]
+        return bytes(data)
+
+    def sample_raw(self, count, mode='uniform'):
+        """Returns (records, entries, total inserted); records is empty while the buffer is."""
+        self.sock.sendall(b'RBQ1' + struct.pack('<IB3x', count, REPLAY_MODES[mode]))
+        n, n_entries, inserted = struct.unpack('<IIQ', self._recv(16))
+        records = np.frombuffer(self._recv(n * COMPACT_RECORD_DTYPE.itemsize), dtype=COMPACT_RECORD_DTYPE)
+        entries = np.frombuffer(self._recv(n_entries * COMPACT_POLICY_DTYPE.itemsize), dtype=COMPACT_POLICY_DTYPE)
+        return records, entries, inserted
+
+    def sample(self, count, mode='uniform'):
+        records, entries, _ = self.sample_raw(count, mode)
+        return expand_compact(records, entries)
+
+def load_training_data_replay(endpoint, count, mode='uniform'):
+    """Draws `count` samples from a live replay buffer (tcp://host:port), no files involved."""
+    client = ReplayBufferClient(endpoint)
+    records, entries = [], []
+    while sum(len(r) for r in records) < count:
+        r, e, _ = client.sample_raw(min(REPLAY_MAX_BATCH, count - sum(len(r) for r in records)), mode)
+        if len(r) == 0:
+            raise SystemExit(f"Replay buffer at {endpoint} is empty.")
+        records.append(r)
+        entries.append(e)
+    return expand_compact(np.concatenate(records), np.concatenate(entries))
+
+def load_training_data(path, replay_samples=0, replay_mode='uniform'):
+    """Returns {'bidding': (features, policy, value), 'playing': (features, policy, outcome)} as
+    numpy arrays (memory-mapped for columnar directories, in memory for Protobuf and compact files).
+    Compact, replay and columnar data also carry {'sampling_rate': {'bidding': ..., 'playing': ...}}
+    and a 'fast_search' mask of the same shape."""
+    if path.startswith('tcp://'):
+        return load_training_data_replay(path[len('tcp://'):], replay_samples, replay_mode)
+    if os.path.isdir(path):
+        return load_training_data_columnar(path)
+    if is_compact_file(path):
+        return load_training_data_compact(path)
+    samples = load_training_data_chunked(path) if is_chunked_file(path) else load_training_data_proto(path)
+    as_arrays = lambda items: tuple(
+        np.array([item[i] for item in items], dtype=np.float32).reshape(len(items), -1) if items else np.zeros((0, 1), dtype=np.float32)
+        for i in range(3))
+    return {'bidding': as_arrays(samples['bidding']), 'playing': as_arrays(samples['playing'])}
 
-def export_model_to_onnx(model, dummy_input, filepath):
+class ArrayBatchDataset(Dataset):
+    """Serves whole batches by fancy-indexing the arrays with sorted row indices, which keeps
+    reads from memory-mapped columns mostly sequential."""
+    def __init__(self, *arrays):
+        self.arrays = arrays
+    def __len__(self):
+        return len(self.arrays[0])
+    def __getitem__(self, indices):
+        indices = np.sort(np.asarray(indices))
+        return tuple(torch.from_numpy(np.ascontiguousarray(a[indices], dtype=np.float32).reshape(len(indices), -1))
+                     for a in self.arrays)
+
+def make_loader(arrays, batch_size):
+    dataset = ArrayBatchDataset(*arrays)
+    sampler = BatchSampler(RandomSampler(dataset), batch_size=batch_size, drop_last=False)
+    return DataLoader(dataset, sampler=sampler, batch_size=None)
+
+
+def export_model_to_onnx(model, dummy_input, filepath, output_names=('output',)):
     """Exports a PyTorch model to ONNX format."""
     print(f"Exporting model to {filepath}...")
+    output_names = list(output_names)
+    dynamic_axes = {'input': {0: 'batch_size'}}
+    dynamic_axes.update({name: {0: 'batch_size'} for name in output_names})
     torch.onnx.export(
         model,
         dummy_input,
@@ -93,8 +400,8 @@ def export_model_to_onnx(model, dummy_input, filepath):
         opset_version=10,
         do_constant_folding=True,
         input_names=['input'],
-        output_names=['output'],
-        dynamic_axes={'input': {0: 'batch_size'}, 'output': {0: 'batch_size'}},
+        output_names=output_names,
+        dynamic_axes=dynamic_axes,
         dynamo=True
     )
     print("Export complete.")
@@ -109,12 +416,17 @@ def generate_random_onnx_model(model_type, input_size, output_dir):
         model = PlayingModelNN2(input_size=input_size) # Adjust input_size later
         dummy_input = torch.randn(1, input_size)
         onnx_filename = os.path.join(output_dir, "nn2_model.onnx")
+    elif model_type == 'pv':
+        model = PolicyValueModel(input_size=input_size)
+        dummy_input = torch.randn(1, input_size)
+        onnx_filename = os.path.join(output_dir, "pv_model.onnx")
     else:
         raise ValueError("Invalid model_type for random model generation.")
 
     # Ensure model is in eval mode for export
     model.eval()
-    export_model_to_onnx(model, dummy_input, onnx_filename)
+    output_names = ('policy', 'value') if model_type == 'pv' else ('output',)
+    export_model_to_onnx(model, dummy_input, onnx_filename, output_names)
     print(f"Generated random {model_type.upper()} ONNX model at {onnx_filename}")
 
 # --- Main Training Logic ---
@@ -128,23 +440,23 @@ def main(args):
         # For NN2 (Playing), input_size is more complex:
         # 4 (scores/bags) + 4 (bids) + 52 (hand) + 52 (trick) + 4 (tricks_won) + 1 (spades_broken) + 1 (current_player_idx) = 118
         # If your PlayingModelNN2 default input_size is different, update it here.
-        play_input_size = 118 # As derived from DataCollector::extractPlayFeatures
+        play_input_size = 118 # FeatureEncoder::kPlayFeatureCount
         
         generate_random_onnx_model('nn1', bid_input_size, args.output_model_path)
         generate_random_onnx_model('nn2', play_input_size, args.output_model_path)
+        if args.fused:
+            generate_random_onnx_model('pv', play_input_size, args.output_model_path)
         return
-    print("Loading training data from Protobuf file...")
-    # Call the new, safe data loader
-    all_data = load_training_data_proto(args.input_data_path)
+    print(f"Loading training data from {args.input_data_path}...")
+    # Protobuf and chunked .bin files are parsed and compact files expanded into memory; columnar directories are memory-mapped
+    all_data = load_training_data(args.input_data_path, args.replay_samples, args.replay_sampling)
+    X_bid, y_policy_bid, _ = all_data['bidding']
+    X_play, y_policy_play, y_value_play = all_data['playing']
 
     # --- Train Bidding Model (NN1) ---
-    if all_data['bidding']:
-        print(f"Found {len(all_data['bidding'])} bidding samples.")
-        X_bid = torch.tensor(np.array([item[0] for item in all_data['bidding']]), dtype=torch.float32)
-        y_policy_bid = torch.tensor(np.array([item[1] for item in all_data['bidding']]), dtype=torch.float32)
-
-        train_dataset = TensorDataset(X_bid, y_policy_bid)
-        train_loader = DataLoader(train_dataset, batch_size=args.batch_size, shuffle=True)
+    if len(X_bid) > 0:
+        print(f"Found {len(X_bid)} bidding samples.")
+        train_loader = make_loader((X_bid, y_policy_bid), args.batch_size)
 
         nn1_path_pth = os.path.join(args.output_model_path, "nn1_model.pth")
         nn1_path_onnx = os.path.join(args.output_model_path, "nn1_model.onnx")
@@ -182,20 +494,60 @@ def main(args):
     # --- Train Playing Model (NN2) ---
     # As noted, this part is a placeholder. A full implementation requires
     # careful handling of state representation and variable-sized policies.
-    if all_data['playing']:
-        print(f"\nFound {len(all_data['playing'])} playing samples.")
+    if len(X_play) > 0:
+        print(f"\nFound {len(X_play)} playing samples.")
         print("WARNING: NN2 training is a placeholder and is currently skipped.")
     else:
         print("\nNo playing data found to train NN2.")
 
+    # --- Train Fused Policy+Value Model ---
+    if args.fused and len(X_play) > 0:
+        train_loader = make_loader((X_play, y_policy_play, y_value_play), args.batch_size)
+
+        pv_path_pth = os.path.join(args.output_model_path, "pv_model.pth")
+        pv_path_onnx = os.path.join(args.output_model_path, "pv_model.onnx")
+
+        input_size = X_play.shape[1]
+        model_pv = PolicyValueModel(input_size=input_size)
+        if os.path.exists(pv_path_pth):
+            print("Loading existing policy+value model to continue training...")
+            model_pv.load_state_dict(torch.load(pv_path_pth))
+        else:
+            print("Creating new policy+value model...")
+
+        value_criterion = nn.BCELoss()
+        optimizer = optim.Adam(model_pv.parameters(), lr=0.001)
+
+        model_pv.train()
+        for epoch in range(args.epochs):
+            progress_bar = tqdm(train_loader, desc=f"PV Epoch {epoch+1}/{args.epochs}", leave=False)
+            for states, policies, values in progress_bar:
+                optimizer.zero_grad()
+                policy_out, value_out = model_pv(states)
+                # Cross-entropy against the MCTS visit distribution (padded entries are zero).
+                policy_loss = -(policies * torch.log(policy_out + 1e-8)).sum(dim=1).mean()
+                value_loss = value_criterion(value_out, values)
+                loss = policy_loss + value_loss
+                loss.backward()
+                optimizer.step()
+                progress_bar.set_postfix({'policy': f'{policy_loss.item():.4f}', 'value': f'{value_loss.item():.4f}'})
+
+        print("Policy+value training finished.")
+        torch.save(model_pv.state_dict(), pv_path_pth)
+        print(f"PyTorch model saved to {pv_path_pth}")
+        export_model_to_onnx(model_pv, torch.randn(1, input_size), pv_path_onnx, ('policy', 'value'))
+
 if __name__ == '__main__':
     parser = argparse.ArgumentParser(description="Train Spades AI models from self-play data using PyTorch.")
     parser.add_argument("--mode", type=str, default="train", choices=['train', 'generate_initial_models'],
                         help="Operation mode: 'train' to train from data, or 'generate_initial_models' to create new random models.")
-    parser.add_argument("--input-data-path", type=str, help="Path to the .bin file generated by the C++ app. Required for 'train' mode.")
+    parser.add_argument("--input-data-path", type=str, help="Path to the .bin file (plain or chunked), compact file or columnar dataset directory generated by the C++ app, or tcp://host:port of a self_play replay buffer. Required for 'train' mode.")
+    parser.add_argument("--replay-samples", type=int, default=65536, help="Samples to draw per run when training from a replay buffer.")
+    parser.add_argument("--replay-sampling", type=str, default="uniform", choices=list(REPLAY_MODES), help="How the replay buffer draws samples.")
     parser.add_argument("--output-model-path", type=str, required=True, help="Directory to save or generate the models.")
     parser.add_argument("--epochs", type=int, default=10, help="Number of epochs to train for.")
     parser.add_argument("--batch-size", type=int, default=64, help="Training batch size.")
+    parser.add_argument("--fused", action="store_true", help="Also generate/train the two-headed policy+value model (pv_model.onnx).")
     args = parser.parse_args()
 
     # Validate arguments based on mode